@@ -0,0 +1,83 @@
+/***************************************************************************
+ *                           KernelTable.cpp                               *
+ *                           -------------------                           *
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "KernelTable.h"
+
+
+const float KernelTable::Tolerance=1.0e-6f;
+
+std::map<std::pair<double, double>, KernelTable *> KernelTable::CosTables;
+
+std::map<std::pair<double, double>, KernelTable *> KernelTable::SinTables;
+
+
+KernelTable::KernelTable(double NewMaxTime): MaxTime(NewMaxTime), aux((TableSize-1)/NewMaxTime){
+}
+
+
+const KernelTable * KernelTable::GetCosKernel(double exponent, double tau){
+	KernelTable * Table;
+
+	// Synapses might be created in parallel, so the tables are generated only once
+	#pragma omp critical (KernelTable)
+	{
+		std::pair<double, double> key(exponent, tau);
+		std::map<std::pair<double, double>, KernelTable *>::iterator it = CosTables.find(key);
+		if (it==CosTables.end()){
+			// The cos^2 term is periodic, so the table ends when the exponential decay vanishes
+			Table = new KernelTable(-log(Tolerance)*tau/exponent);
+
+			const double HalfPi = 2.0*atan(1.0);
+			for(int i=0; i<TableSize; i++){
+				double t = (Table->MaxTime*i)/(TableSize-1);
+				double CosVar = cos(HalfPi*t/tau);
+				Table->LookUpTable[i] = exp(-exponent*t/tau)*CosVar*CosVar;
+			}
+
+			CosTables[key] = Table;
+		} else {
+			Table = it->second;
+		}
+	}
+
+	return Table;
+}
+
+
+const KernelTable * KernelTable::GetSinKernel(unsigned int exponent, double peak){
+	KernelTable * Table;
+
+	#pragma omp critical (KernelTable)
+	{
+		std::pair<double, double> key(exponent, peak);
+		std::map<std::pair<double, double>, KernelTable *>::iterator it = SinTables.find(key);
+		if (it==SinTables.end()){
+			double inv_tau = atan((double) exponent)/peak;
+			double factor = 1.0/(exp(-atan((double) exponent))*pow(sin(atan((double) exponent)),(int) exponent));
+
+			Table = new KernelTable(-log(Tolerance)/inv_tau);
+
+			for(int i=0; i<TableSize; i++){
+				double t = (Table->MaxTime*i)/(TableSize-1);
+				Table->LookUpTable[i] = factor*exp(-t*inv_tau)*pow(sin(t*inv_tau),(int) exponent);
+			}
+
+			SinTables[key] = Table;
+		} else {
+			Table = it->second;
+		}
+	}
+
+	return Table;
+}
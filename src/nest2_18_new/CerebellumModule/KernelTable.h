@@ -0,0 +1,130 @@
+/***************************************************************************
+ *                           KernelTable.h                                 *
+ *                           -------------------                           *
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef KERNELTABLE_H_
+#define KERNELTABLE_H_
+
+#include <cmath>
+#include <map>
+#include <utility>
+
+/*!
+ * \file KernelTable.h
+ *
+ * This file declares a look-up table for the learning kernels of the
+ * stdp_cos_synapse and stdp_sin_synapse models, tabulated directly as a
+ * function of the time elapsed since a presynaptic spike.
+ */
+
+
+
+class KernelTable{
+
+   	public:
+
+		/*!
+   		 * Number of look-up table elements.
+   		 */
+		static const int TableSize=1024*16;
+
+		/*!
+   		 * Relative amplitude below which the kernel is considered to be zero.
+   		 */
+		static const float Tolerance;
+
+		/*!
+		 * \brief It gets the table of the cosine kernel.
+		 *
+		 * It gets the table of f(t) = exp(-exponent*t/tau)*cos(pi/2*t/tau)^2,
+		 * the kernel evolved by the cos2 trace of stdp_cos_synapse. Tables are
+		 * shared between all the synapses with the same parameters.
+		 *
+		 * \param exponent Exponent of the cosine learning rule.
+		 * \param tau Time constant of the cosine learning rule (in ms).
+		 *
+		 * \return the look-up table.
+		 */
+		static const KernelTable * GetCosKernel(double exponent, double tau);
+
+		/*!
+		 * \brief It gets the table of the sine kernel.
+		 *
+		 * It gets the table of f(t) = factor*exp(-t/tau)*sin(t/tau)^exponent,
+		 * the kernel evolved by the state variables of stdp_sin_synapse. Tables
+		 * are shared between all the synapses with the same parameters.
+		 *
+		 * \param exponent Exponent of the sine learning rule.
+		 * \param peak Time of the peak of the kernel (in ms).
+		 *
+		 * \return the look-up table.
+		 */
+		static const KernelTable * GetSinKernel(unsigned int exponent, double peak);
+
+   		/*!
+   		 * \brief It gets the kernel value for an elapsed time.
+   		 *
+   		 * It gets the kernel value for an elapsed time. The kernel is zero for
+   		 * negative times and beyond the end of the table.
+   		 *
+   		 * \param ElapsedTime time since the presynaptic spike (in ms).
+   		 *
+   		 * \return the kernel value.
+   		 */
+		float GetResult(double ElapsedTime) const{
+			if(ElapsedTime>=0.0 && ElapsedTime<MaxTime){
+				int position=int(ElapsedTime*aux+0.5);
+				return LookUpTable[position];
+			}else{
+				return 0.0f;
+			}
+		}
+
+		/*!
+		 * \brief It gets the time beyond which the kernel is zero.
+		 *
+		 * \return the length of the kernel (in ms).
+		 */
+		double GetMaxTime() const{
+			return MaxTime;
+		}
+
+	private:
+
+		/*!
+		 * Kernel values, sampled every MaxTime/(TableSize-1) ms.
+		 */
+		float LookUpTable[TableSize];
+
+		/*!
+		 * Length of the kernel (in ms).
+		 */
+		double MaxTime;
+
+		/*!
+		 * Auxiliar variable (inverse of the sampling step).
+		 */
+		double aux;
+
+		KernelTable(double NewMaxTime);
+
+		/*!
+		 * Tables already generated, indexed by their parameters.
+		 */
+		static std::map<std::pair<double, double>, KernelTable *> CosTables;
+		static std::map<std::pair<double, double>, KernelTable *> SinTables;
+
+};
+
+
+#endif /*KERNELTABLE_H_*/
@@ -29,8 +29,12 @@
 
 #include "archiving_node_cos.h"
 #include "dictutils.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <limits>
 
 #include "ExponentialTable.h"
 #include "TrigonometricTable.h"
@@ -41,6 +45,7 @@ namespace nest
   {
     const Name tau_cos("tau_cos");
     const Name exponent("exponent");
+    const Name checkpoint_interval("checkpoint_interval");
   }
 }
 
@@ -52,80 +57,345 @@ namespace mynest {
   Archiving_Node_Cos::Archiving_Node_Cos() :
       Archiving_Node(),
       n_incoming_cos_(0),
+      n_incoming_std_(0),
       tau_cos_(1.0),
       inv_tau_cos_(1.0),
       exponent_(1.0),
+      checkpoint_interval_(8),
       cos2_(0.0),
       sin2_(0.0),
       cossin_(0.0),
   		last_cos_spike_(-1.0),
-      history_cos_()
+      history_cos_(),
+      checkpoints_cos_(),
+      spikes_since_checkpoint_(0),
+      base_step_cos_(0),
+      pending_registrations_cos_(),
+      cache_valid_(false),
+      cache_t_(0.0),
+      cache_cos2_(0.0),
+      cache_sin2_(0.0),
+      cache_cossin_(0.0),
+      push_t_last_(),
+      push_cos2_(),
+      push_sin2_(),
+      push_cossin_(),
+      push_ltd_(),
+      push_free_slots_(),
+      push_recent_cs_()
   		{
   		}
 
   Archiving_Node_Cos::Archiving_Node_Cos(const Archiving_Node_Cos& n)
   :Archiving_Node(n),
   n_incoming_cos_(n.n_incoming_cos_),
+  n_incoming_std_(n.n_incoming_std_),
   tau_cos_(n.tau_cos_),
   inv_tau_cos_(n.inv_tau_cos_),
   exponent_(n.exponent_),
+  checkpoint_interval_(n.checkpoint_interval_),
   cos2_(n.cos2_),
   sin2_(n.sin2_),
   cossin_(n.cossin_),
   last_cos_spike_(n.last_cos_spike_),
-  history_cos_()
+  history_cos_(),
+  checkpoints_cos_(),
+  spikes_since_checkpoint_(0),
+  base_step_cos_(0),
+  pending_registrations_cos_(),
+  cache_valid_(false),
+  cache_t_(0.0),
+  cache_cos2_(0.0),
+  cache_sin2_(0.0),
+  cache_cossin_(0.0),
+  push_t_last_(),
+  push_cos2_(),
+  push_sin2_(),
+  push_cossin_(),
+  push_ltd_(),
+  push_free_slots_(),
+  push_recent_cs_()
     {}
 
   void Archiving_Node_Cos::register_stdp_connection_cos(double t_first_read){
-    // Mark all entries in the deque, which we will not read in future as read by this input
-    // input, so that we savely increment the incoming number of
-    // connections afterwards without leaving spikes in the history.
-    // For details see bug #218. MH 08-04-22
-  	for ( std::deque<histentry_cos>::iterator runner = history_cos_.begin();
-      runner != history_cos_.end() && runner->t_ <= t_first_read;
+    // The connection is counted right away, but marking the entries which
+    // it will not read is deferred, so that registering many connections
+    // (e.g., while connecting a projection) walks the history only once. The
+    // unmarked entries are just not pruned in the meantime. NEST creates every
+    // connection in the thread of its target, so these counters are never
+    // modified concurrently.
+    n_incoming_cos_++;
+
+    long t_first_read_steps;
+    float t_first_read_offset;
+    this->to_history_stamp_cos( t_first_read, t_first_read_steps, t_first_read_offset );
+
+    // There are no entries to be skipped by this connection
+    if ( history_cos_.empty() || is_later( history_cos_.front().t_steps_, history_cos_.front().offset_, t_first_read_steps, t_first_read_offset ) ){
+      return;
+    }
+
+    // Connections from the same source share t_first_read
+    if ( !pending_registrations_cos_.empty() && pending_registrations_cos_.back().first == t_first_read ){
+      pending_registrations_cos_.back().second++;
+    } else {
+      pending_registrations_cos_.push_back( std::make_pair( t_first_read, (size_t) 1 ) );
+    }
+  }
+
+  void Archiving_Node_Cos::apply_pending_registrations_cos(){
+    if ( pending_registrations_cos_.empty() ){
+      return;
+    }
+
+    // Mark all entries in the deque, which the pending inputs will not read in
+    // future, as read by them. For details see bug #218. MH 08-04-22
+    std::sort( pending_registrations_cos_.begin(), pending_registrations_cos_.end() );
+
+    // Number of pending inputs with t_first_read >= t of the current entry
+    size_t n_marks = 0;
+    for ( std::vector< std::pair< double, size_t > >::const_iterator pending = pending_registrations_cos_.begin();
+      pending != pending_registrations_cos_.end();
+      ++pending ){
+      n_marks += pending->second;
+    }
+
+    std::vector< std::pair< double, size_t > >::const_iterator pending = pending_registrations_cos_.begin();
+    long pending_steps;
+    float pending_offset;
+    this->to_history_stamp_cos( pending->first, pending_steps, pending_offset );
+    for ( std::deque<histentry_cos>::iterator runner = history_cos_.begin();
+      runner != history_cos_.end() && n_marks > 0;
       ++runner){
-      (runner->access_counter_)++;
+      while ( n_marks > 0 && is_later( runner->t_steps_, runner->offset_, pending_steps, pending_offset ) ){
+        n_marks -= pending->second;
+        ++pending;
+        if ( pending != pending_registrations_cos_.end() ){
+          this->to_history_stamp_cos( pending->first, pending_steps, pending_offset );
+        }
+      }
+      runner->access_counter_ += n_marks;
+    }
+
+    pending_registrations_cos_.clear();
+  }
+
+  void Archiving_Node_Cos::unregister_stdp_connection_cos(double t_last_read){
+    this->apply_pending_registrations_cos();
+
+    // Remove the marks of this input from the entries it has already read, so
+    // that they are not pruned before the remaining inputs read them
+    long t_last_read_steps;
+    float t_last_read_offset;
+    this->to_history_stamp_cos( t_last_read, t_last_read_steps, t_last_read_offset );
+    for ( std::deque<histentry_cos>::iterator runner = history_cos_.begin();
+      runner != history_cos_.end() && !is_later( runner->t_steps_, runner->offset_, t_last_read_steps, t_last_read_offset );
+      ++runner){
+      (runner->access_counter_)--;
+    }
+    n_incoming_cos_--;
+
+    // No input will read the history anymore
+    if (n_incoming_cos_ == 0){
+      history_cos_.clear();
+      checkpoints_cos_.clear();
+      pending_registrations_cos_.clear();
+      this->cache_valid_ = false;
+    }
+  }
+
+  size_t Archiving_Node_Cos::register_push_connection_cos(){
+    if (!push_free_slots_.empty()){
+      const size_t slot = push_free_slots_.back();
+      push_free_slots_.pop_back();
+      return slot;
+    }
+
+    push_t_last_.push_back(0.0);
+    push_cos2_.push_back(0.0f);
+    push_sin2_.push_back(0.0f);
+    push_cossin_.push_back(0.0f);
+    push_ltd_.push_back(0.0f);
+    return push_t_last_.size() - 1;
+  }
+
+  void Archiving_Node_Cos::unregister_push_connection_cos(size_t slot){
+    // The traces of a free slot are kept at zero, so the sweeps add no LTD
+    // to it and the next connection starts from a clean trace
+    push_t_last_[slot] = 0.0;
+    push_cos2_[slot] = 0.0f;
+    push_sin2_[slot] = 0.0f;
+    push_cossin_[slot] = 0.0f;
+    push_ltd_[slot] = 0.0f;
+    push_free_slots_.push_back(slot);
+  }
+
+  double Archiving_Node_Cos::take_push_ltd_cos(size_t slot){
+    double ltd = push_ltd_[slot];
+    push_ltd_[slot] = 0.0f;
+    return ltd;
+  }
+
+  void Archiving_Node_Cos::add_push_spike_cos(size_t slot, double t){
+    double cos2, sin2, cossin;
+
+    // Evolve the state variables until the presynaptic spike time
+    this->evolve_cos_values( t - push_t_last_[slot],
+                             push_cos2_[slot], push_sin2_[slot], push_cossin_[slot],
+                             cos2, sin2, cossin );
+
+    // Apply the effect of the incoming spike into the state variables
+    push_cos2_[slot] = cos2 + 1.0;
+    push_sin2_[slot] = sin2;
+    push_cossin_[slot] = cossin;
+    push_t_last_[slot] = t;
+
+    // A spike with a longer delay than the teaching signal is added after
+    // the sweep of the later teaching spikes, so their LTD due to this spike
+    // is added here
+    for ( std::deque< std::pair< double, unsigned int > >::const_iterator it = push_recent_cs_.begin();
+      it != push_recent_cs_.end(); ++it ){
+      if ( it->first > t ){
+        this->evolve_cos_values( it->first - t, 1.0, 0.0, 0.0, cos2, sin2, cossin );
+        push_ltd_[slot] += it->second*cos2;
+      }
+    }
+  }
+
+  void Archiving_Node_Cos::apply_push_ltd_cos(double t_cs, unsigned int multiplicity){
+    const size_t n = push_t_last_.size();
+
+    const double* t_last = &push_t_last_[0];
+    const float* old_cos2 = &push_cos2_[0];
+    const float* old_sin2 = &push_sin2_[0];
+    const float* old_cossin = &push_cossin_[0];
+    float* ltd = &push_ltd_[0];
+
+    const float exponent = this->exponent_;
+    const float inv_tau = this->inv_tau_cos_;
+    const float n_spikes = multiplicity;
+
+    // The look-up tables are accessed directly (instead of through
+    // GetResult and GetElement) to keep the loop free of branches and calls
+    const float* ExpLUT = ExponentialTable::LookUpTable;
+    const float ExpMin = ExponentialTable::Min;
+    const float ExpAux = ExponentialTable::aux;
+    const float* TrigLUT = TrigonometricTable::TrigonometricLUT;
+    const float TrigInvStep = TrigonometricTable::inv_LUTStep;
+    // N_ELEMENTS is a power of two, so the modulo of CalculateValidPosition
+    // reduces to a mask
+    const int TrigMask = TrigonometricTable::N_ELEMENTS*2 - 1;
+
+    // Same evolution as evolve_cos_values, but only cos2 is needed. A
+    // presynaptic spike later than the teaching spike (delivered earlier
+    // because of its shorter delay) is approximated by the trace right
+    // before it.
+    #pragma omp simd
+    for ( size_t i = 0; i < n; ++i ){
+      // Floating point comparisons are avoided because, with trapping math,
+      // they keep the compiler from converting the selections into masks
+      float ElapsedTime = t_cs - t_last[i];
+      const bool is_late = std::signbit( ElapsedTime );
+      const float late = is_late ? 1.0f : 0.0f;
+      ElapsedTime = is_late ? 0.0f : ElapsedTime;
+
+      // The exponent is never positive, so only the lower bound of the table
+      // has to be checked
+      const float ExpValue = -exponent*ElapsedTime*inv_tau;
+      const int ExpPosition = int((ExpValue-ExpMin)*ExpAux);
+      const float ExpLUTValue = ExpLUT[( ExpPosition < 0 ) ? 0 : ExpPosition];
+      const float expon = ( ExpPosition < 0 ) ? 0.0f : ExpLUTValue;
+
+      const int LUTindex = (((int)(ElapsedTime*inv_tau*1.5708f*TrigInvStep + 0.5f))*2) & TrigMask;
+
+      const float SinVar = TrigLUT[LUTindex];
+      const float CosVar = TrigLUT[LUTindex+1];
+
+      ltd[i] += n_spikes*expon*((old_cos2[i]-late) * CosVar*CosVar + old_sin2[i]*SinVar*SinVar - 2*old_cossin[i]*CosVar*SinVar);
     }
-    n_incoming_cos_++;
   }
 
   void Archiving_Node_Cos::get_cos_values( double t,
                                     double& cos2,
                                     double& sin2,
                                     double& cossin ){
-    // case when the neuron has not yet spiked. Evolved the state at the last
-    // fired spike until the current time
-    if ( history_cos_.empty() ) {
-      cos2 = this->cos2_;
-      sin2 = this->sin2_;
-      cossin = this->cossin_;
-      return;
+    // All the presynaptic spikes arriving in the same time step query the
+    // trace at the same time
+    if ( !this->cache_valid_ || t != this->cache_t_ ){
+      this->compute_cos_values( t, this->cache_cos2_, this->cache_sin2_, this->cache_cossin_ );
+      this->cache_t_ = t;
+      this->cache_valid_ = true;
     }
-    
-    // case
-    int i = history_cos_.size() - 1;
-    while ( i >= 0 ){
-      if ( t > history_cos_[ i ].t_ ){
-        this->evolve_cos_values(t - history_cos_[ i ].t_,
-                            history_cos_[ i ].cos2_,
-                            history_cos_[ i ].sin2_,
-                            history_cos_[ i ].cossin_,
-                            cos2, sin2, cossin);
 
-        //std::cout << "Evolving postsynaptic trace from " << history_cos_[i].t_ << " to " << t << 
-        //". Init values: " << history_cos_[ i ].cos2_ << " " << history_cos_[ i ].sin2_ << " " << history_cos_[ i ].cossin_ <<
-        //". Final values: " << cos2 << " " << sin2 << " " << cossin << " Parameters: " << this->inv_tau_cos_ << " " << this->exponent_ << std::endl;
+    cos2 = this->cache_cos2_;
+    sin2 = this->cache_sin2_;
+    cossin = this->cache_cossin_;
+  }
 
-        return;
+  void Archiving_Node_Cos::compute_cos_values( double t,
+                                    double& cos2,
+                                    double& sin2,
+                                    double& cossin ){
+    // The running trace holds the state right after the last spike. It is
+    // also used when the neuron has not yet spiked
+    if ( history_cos_.empty() || t > this->last_cos_spike_ ) {
+      if ( t > this->last_cos_spike_ ){
+        this->evolve_cos_values(t - this->last_cos_spike_,
+                            this->cos2_, this->sin2_, this->cossin_,
+                            cos2, sin2, cossin);
+      } else {
+        cos2 = this->cos2_;
+        sin2 = this->sin2_;
+        cossin = this->cossin_;
       }
+      return;
+    }
+
+    // Last spike in the history before t
+    int i = history_cos_.size() - 1;
+    while ( i >= 0 && this->get_cos_time( history_cos_[ i ] ) >= t ){
       i--;
     }
 
     // we only get here if t< time of all spikes in history)
     // return 0.0 for both K values
-    cos2 = 0.0;
-    sin2 = 0.0;
-    cossin = 0.0;
+    if ( i < 0 ){
+      cos2 = 0.0;
+      sin2 = 0.0;
+      cossin = 0.0;
+      return;
+    }
+
+    // Last checkpoint at or before that spike
+    std::deque<histcheckpoint_cos>::const_reverse_iterator checkpoint = checkpoints_cos_.rbegin();
+    while ( is_later( checkpoint->t_steps_, checkpoint->offset_, history_cos_[ i ].t_steps_, history_cos_[ i ].offset_ ) ){
+      ++checkpoint;
+    }
+
+    int first = i;
+    while ( is_later( history_cos_[ first ].t_steps_, history_cos_[ first ].offset_, checkpoint->t_steps_, checkpoint->offset_ ) ){
+      first--;
+    }
+
+    // Replay the spikes between the checkpoint and that spike
+    double t_prev = this->steps_to_ms( checkpoint->t_steps_ ) - checkpoint->offset_;
+    cos2 = checkpoint->cos2_;
+    sin2 = checkpoint->sin2_;
+    cossin = checkpoint->cossin_;
+    for ( int j = first + 1; j <= i; ++j ){
+      const double t_entry = this->get_cos_time( history_cos_[ j ] );
+      if ( t_entry != t_prev ){
+        this->evolve_cos_values(t_entry - t_prev,
+                            cos2, sin2, cossin,
+                            cos2, sin2, cossin);
+      }
+      cos2 += history_cos_[ j ].multiplicity_;
+      t_prev = t_entry;
+    }
+
+    this->evolve_cos_values(t - t_prev,
+                        cos2, sin2, cossin,
+                        cos2, sin2, cossin);
     return;
   }
 
@@ -167,10 +437,17 @@ namespace mynest {
       *start = *finish;
       return;
     } else {
+      // Times in the representation of the history. With on-grid spikes
+      // only the steps are compared
+      long t1_steps, t2_steps;
+      float t1_offset, t2_offset;
+      this->to_history_stamp_cos( t1, t1_steps, t1_offset );
+      this->to_history_stamp_cos( t2, t2_steps, t2_offset );
+
       std::deque<mynest::histentry_cos>::iterator runner = history_cos_.begin();
-      while ((runner != history_cos_.end()) && (runner->t_ <= t1)) ++runner;
+      while ((runner != history_cos_.end()) && !is_later(runner->t_steps_, runner->offset_, t1_steps, t1_offset)) ++runner;
       *start = runner;
-      while ((runner != history_cos_.end()) && (runner->t_ <= t2)) {
+      while ((runner != history_cos_.end()) && !is_later(runner->t_steps_, runner->offset_, t2_steps, t2_offset)) {
         (runner->access_counter_)++;
         ++runner;
   	  }
@@ -178,33 +455,208 @@ namespace mynest {
     }
   }
 
-  void mynest::Archiving_Node_Cos::set_cos_spiketime(nest::Time const & t_sp, double offset)
+  void mynest::Archiving_Node_Cos::set_cos_spiketime(nest::Time const & t_sp, unsigned int multiplicity, double offset)
   {
+    // The spikes are not delivered in time order, since they arrive with
+    // different delays. A spike earlier than the last one is inserted at its
+    // position, which is at most the max delay before the end of the history
     const double t_sp_ms = t_sp.get_ms() - offset;
 
     if (n_incoming_cos_){
+      this->apply_pending_registrations_cos();
+
       // prune all spikes from history which are no longer needed
-      // except the penultimate one. we might still need it.
+      // except the penultimate one. we might still need it. The spikes
+      // within the max delay before the last one are kept as well, so that
+      // a spike delivered late always has an earlier entry to follow
+      const double t_keep = this->last_cos_spike_
+        - nest::Time( nest::Time::step( nest::kernel().connection_manager.get_max_delay() ) ).get_ms();
       while (history_cos_.size() > 1){
-        if (history_cos_.front().access_counter_ >= n_incoming_cos_){
-          history_cos_.pop_front();
+        if (history_cos_.front().access_counter_ >= n_incoming_cos_
+          && this->get_cos_time( history_cos_[ 1 ] ) <= t_keep){
+          this->pop_cos_history();
         } else {
           break;
         }
-      }  
+      }
+    }
 
-      this->evolve_cos_values( t_sp_ms - this->last_cos_spike_,
-                                  this->cos2_, this->sin2_, this->cossin_,
-                                  this->cos2_, this->sin2_, this->cossin_);
+    // The trace is kept up to date even if no plastic input is recording
+    // the history, so that it is valid when an input is (re)registered.
+    // Spikes at the same time are added without evolving the trace, and a
+    // spike earlier than the last one adds its kernel evolved until then.
+    if ( t_sp_ms < this->last_cos_spike_ ){
+      double cos2, sin2, cossin;
+      this->evolve_cos_values( this->last_cos_spike_ - t_sp_ms,
+                               multiplicity, 0.0, 0.0,
+                               cos2, sin2, cossin );
+      this->cos2_ += cos2;
+      this->sin2_ += sin2;
+      this->cossin_ += cossin;
+    } else {
+      if ( t_sp_ms != this->last_cos_spike_ ){
+        this->evolve_cos_values( t_sp_ms - this->last_cos_spike_,
+                                    this->cos2_, this->sin2_, this->cossin_,
+                                    this->cos2_, this->sin2_, this->cossin_);
+      }
 
-      this->cos2_ += 1.0;
+      this->cos2_ += multiplicity;
       last_cos_spike_ = t_sp_ms;
-      history_cos_.push_back( histentry_cos( last_cos_spike_, this->cos2_, this->sin2_, this->cossin_, 0 ) );
+    }
+    this->cache_valid_ = false;
+
+    if (!push_t_last_.empty()){
+      this->apply_push_ltd_cos(t_sp_ms, multiplicity);
+
+      // Keep the teaching spikes of the last max delay for the presynaptic
+      // spikes which are earlier but still to be delivered
+      const double t_keep = this->last_cos_spike_
+        - nest::Time( nest::Time::step( nest::kernel().connection_manager.get_max_delay() ) ).get_ms();
+      while ( !push_recent_cs_.empty() && push_recent_cs_.front().first <= t_keep ){
+        push_recent_cs_.pop_front();
+      }
+      push_recent_cs_.push_back( std::make_pair( t_sp_ms, multiplicity ) );
+    }
+
+    if (n_incoming_cos_){
+      long t_steps = t_sp.get_steps() - base_step_cos_;
+      float t_offset = offset;
+      if ( !history_cos_.empty() && is_later( history_cos_.back().t_steps_, history_cos_.back().offset_, t_steps, t_offset ) ){
+        this->insert_cos_history( t_steps, t_offset, multiplicity );
+        return;
+      }
+
+      // Merge the spike into the last entry if it is at the same time and no
+      // input has read that entry yet
+      if ( !history_cos_.empty()
+        && history_cos_.back().t_steps_ == t_steps
+        && history_cos_.back().offset_ == t_offset
+        && history_cos_.back().access_counter_ == 0 ){
+        history_cos_.back().multiplicity_ += multiplicity;
+        if ( checkpoints_cos_.back().t_steps_ == t_steps && checkpoints_cos_.back().offset_ == t_offset ){
+          checkpoints_cos_.back().cos2_ += multiplicity;
+        }
+        return;
+      }
+
+      const unsigned int history_steps = this->to_history_steps_cos( base_step_cos_ + t_steps );
+
+      if ( history_cos_.empty() || spikes_since_checkpoint_ >= (size_t) checkpoint_interval_ ){
+        checkpoints_cos_.push_back( histcheckpoint_cos( history_steps, t_offset, this->cos2_, this->sin2_, this->cossin_ ) );
+        spikes_since_checkpoint_ = 0;
+      }
+
+      history_cos_.push_back( histentry_cos( history_steps, t_offset, multiplicity, 0 ) );
+      spikes_since_checkpoint_++;
+    }
+  }
+
+  void Archiving_Node_Cos::insert_cos_history( long t_steps, float t_offset, unsigned int multiplicity ){
+    // First entry later than the spike
+    std::deque<histentry_cos>::iterator next = history_cos_.end() - 1;
+    while ( next != history_cos_.begin()
+      && is_later( ( next - 1 )->t_steps_, ( next - 1 )->offset_, t_steps, t_offset ) ){
+      --next;
+    }
+
+    if ( next == history_cos_.begin() ){
+      // The trace before the first entry is not known, so a spike earlier
+      // than the whole history (only while it spans less than the max delay)
+      // is moved to the first entry
+      t_steps = next->t_steps_;
+      t_offset = next->offset_;
+      next->multiplicity_ += multiplicity;
+    } else if ( ( next - 1 )->t_steps_ == t_steps && ( next - 1 )->offset_ == t_offset ){
+      // The inputs which have already read the entry at the same time miss
+      // the spike
+      ( next - 1 )->multiplicity_ += multiplicity;
     } else {
-      last_cos_spike_ = t_sp_ms;
+      // The inputs which have read the next entry have gone past the time of
+      // the spike, and will not read it
+      const unsigned int access_counter = next->access_counter_;
+      history_cos_.insert( next, histentry_cos( t_steps, t_offset, multiplicity, access_counter ) );
+      spikes_since_checkpoint_++;
+    }
+
+    // The checkpoints at or after the spike include it
+    const double t_sp_ms = this->steps_to_ms( t_steps ) - t_offset;
+    for ( std::deque<histcheckpoint_cos>::reverse_iterator checkpoint = checkpoints_cos_.rbegin();
+      checkpoint != checkpoints_cos_.rend() && !is_later( t_steps, t_offset, checkpoint->t_steps_, checkpoint->offset_ );
+      ++checkpoint ){
+      double cos2, sin2, cossin;
+      this->evolve_cos_values( this->steps_to_ms( checkpoint->t_steps_ ) - checkpoint->offset_ - t_sp_ms,
+                               multiplicity, 0.0, 0.0,
+                               cos2, sin2, cossin );
+      checkpoint->cos2_ += cos2;
+      checkpoint->sin2_ += sin2;
+      checkpoint->cossin_ += cossin;
+    }
+  }
+
+  void Archiving_Node_Cos::pop_cos_history(){
+    const double t_old = this->get_cos_time( history_cos_[ 0 ] );
+    history_cos_.pop_front();
+
+    // The next spike already has a checkpoint
+    if ( checkpoints_cos_.size() > 1
+      && checkpoints_cos_[ 1 ].t_steps_ == history_cos_.front().t_steps_
+      && checkpoints_cos_[ 1 ].offset_ == history_cos_.front().offset_ ){
+      checkpoints_cos_.pop_front();
+      return;
+    }
+
+    // Move the oldest checkpoint to the next spike
+    histcheckpoint_cos& checkpoint = checkpoints_cos_.front();
+    const double t_new = this->get_cos_time( history_cos_.front() );
+    if ( t_new != t_old ){
+      this->evolve_cos_values( t_new - t_old,
+                               checkpoint.cos2_, checkpoint.sin2_, checkpoint.cossin_,
+                               checkpoint.cos2_, checkpoint.sin2_, checkpoint.cossin_ );
+    }
+    checkpoint.cos2_ += history_cos_.front().multiplicity_;
+    checkpoint.t_steps_ = history_cos_.front().t_steps_;
+    checkpoint.offset_ = history_cos_.front().offset_;
+  }
+
+
+  unsigned int Archiving_Node_Cos::to_history_steps_cos( long t_steps ){
+    if ( history_cos_.empty() ){
+      base_step_cos_ = t_steps;
+    } else if ( t_steps - base_step_cos_ > std::numeric_limits< unsigned int >::max() ){
+      // Move the base to the oldest spike in the history
+      const unsigned int shift = history_cos_.front().t_steps_;
+      for ( std::deque<histentry_cos>::iterator runner = history_cos_.begin();
+        runner != history_cos_.end();
+        ++runner){
+        runner->t_steps_ -= shift;
+      }
+      for ( std::deque<histcheckpoint_cos>::iterator checkpoint = checkpoints_cos_.begin();
+        checkpoint != checkpoints_cos_.end();
+        ++checkpoint){
+        checkpoint->t_steps_ -= shift;
+      }
+      base_step_cos_ += shift;
+
+      if ( t_steps - base_step_cos_ > std::numeric_limits< unsigned int >::max() ){
+        throw nest::KernelException( "The teaching spike history spans too many steps." );
+      }
     }
+
+    return t_steps - base_step_cos_;
   }
 
+  void Archiving_Node_Cos::register_stdp_connection(double t_first_read){
+    n_incoming_std_++;
+    nest::Archiving_Node::register_stdp_connection(t_first_read);
+  }
+
+  void Archiving_Node_Cos::set_spiketime(nest::Time const & t_sp, double offset){
+    // Without standard STDP connections nobody reads the history and the
+    // K-minus traces, so they are not updated
+    if (n_incoming_std_){
+      nest::Archiving_Node::set_spiketime(t_sp, offset);
+    }
+  }
 
   void mynest::Archiving_Node_Cos::get_status(DictionaryDatum & d) const
   {
@@ -212,6 +664,7 @@ namespace mynest {
 
     def< double >( d, nest::names::tau_cos, this->tau_cos_ );
     def< double >( d, nest::names::exponent, this->exponent_ );
+    def< long >( d, nest::names::checkpoint_interval, this->checkpoint_interval_ );
   #ifdef DEBUG_ARCHIVER
     def<int>(d, nest::names::archiver_length, history_cos_.size());
   #endif
@@ -229,7 +682,16 @@ namespace mynest {
       throw nest::BadProperty( "All time constants must be strictly positive." );
     }
 
+    long new_checkpoint_interval = this->checkpoint_interval_;
+    updateValue< long >( d, nest::names::checkpoint_interval, new_checkpoint_interval );
+    if ( new_checkpoint_interval < 1 )
+    {
+      throw nest::BadProperty( "checkpoint_interval must be positive." );
+    }
+    this->checkpoint_interval_ = new_checkpoint_interval;
+
     this->inv_tau_cos_ = 1./this->tau_cos_;
+    this->cache_valid_ = false;
 
     // We need to preserve values in case invalid values are set
 	  // check, if to clear spike history and K_minus
@@ -244,6 +706,11 @@ namespace mynest {
   	Archiving_Node::clear_history();
 
   	history_cos_.clear();
+  	checkpoints_cos_.clear();
+  	pending_registrations_cos_.clear();
+  	this->cache_valid_ = false;
+  	std::fill(push_ltd_.begin(), push_ltd_.end(), 0.0f);
+  	push_recent_cs_.clear();
   }
 
 } // of namespace nest
@@ -37,6 +37,8 @@
 #include "nest_time.h"
 #include "histentry_cos.h"
 #include <deque>
+#include <utility>
+#include <vector>
 
 #define DEBUG_ARCHIVER 1
 
@@ -47,6 +49,7 @@ namespace nest {
     // Neuron parameters
     extern const Name tau_cos;  
     extern const Name exponent;  
+    extern const Name checkpoint_interval;
   }
 }
 
@@ -84,20 +87,67 @@ namespace mynest {
           std::deque<histentry_cos>::iterator* start,
     		  std::deque<histentry_cos>::iterator* finish);
 
+  /**
+   * Time (in ms) of a spike in the history.
+   */
+  double get_cos_time(const histentry_cos& entry) const
+  {
+    return this->steps_to_ms( entry.t_steps_ ) - entry.offset_;
+  }
+
 
   /**
    * \fn void get_cos_value(double t, double cos2, double sin2, double cossin)
-   * return the trace values at the specified time.
+   * return the trace values at the specified time. The last result is cached,
+   * so repeated queries at the same time are answered in constant time.
    */
   void get_cos_values(double t, double& cos2, double& sin2, double& cossin);
 
   /**
-   * Register a new incoming STDP connection.
+   * Register a new incoming STDP connection. The entries it will not read are
+   * marked in a single walk of the history for all the connections registered
+   * before the next pruning.
    *
    * t_first_read: The newly registered synapse will read the history entries with t > t_first_read.
    */
   void register_stdp_connection_cos(double t_first_read);
 
+  /**
+   * Unregister an incoming STDP connection whose plasticity has been frozen.
+   *
+   * t_last_read: The synapse has read (or skipped) the history entries with t <= t_last_read.
+   */
+  void unregister_stdp_connection_cos(double t_last_read);
+
+  /**
+   * Register a new incoming push-mode connection (stdp_cos_push_synapse).
+   * Returns the slot where the presynaptic trace of the connection is stored.
+   */
+  size_t register_push_connection_cos();
+
+  /**
+   * Unregister a push-mode connection that has been disconnected. Its slot
+   * is reused by the next registration.
+   */
+  void unregister_push_connection_cos(size_t slot);
+
+  /**
+   * Return the sum of the presynaptic trace of the slot at the teaching
+   * spikes since the last call, and reset it.
+   */
+  double take_push_ltd_cos(size_t slot);
+
+  /**
+   * Add the effect of a presynaptic spike at time t to the trace of the slot.
+   */
+  void add_push_spike_cos(size_t slot, double t);
+
+  /**
+   * Register a new incoming standard STDP connection. The spike history of
+   * nest::Archiving_Node is only kept while the node has such connections.
+   */
+  void register_stdp_connection(double t_first_read);
+
   void get_status(DictionaryDatum & d) const;
   void set_status(const DictionaryDatum & d);
 
@@ -105,9 +155,17 @@ namespace mynest {
 
   /**
    * \fn void set_spiketime(Time const & t_sp)
-   * record spike history
+   * record spike history. Spikes at the same time are stored in one
+   * entry with their multiplicity.
    */
-  void set_cos_spiketime(nest::Time const & t_sp, double offset=0);
+  void set_cos_spiketime(nest::Time const & t_sp, unsigned int multiplicity=1, double offset=0.0);
+
+  /**
+   * \fn void set_spiketime(Time const & t_sp)
+   * record spike history of nest::Archiving_Node, if a standard STDP
+   * connection needs it
+   */
+  void set_spiketime(nest::Time const & t_sp, double offset=0.0);
 
   /**
    * \fn void clear_history()
@@ -123,6 +181,10 @@ namespace mynest {
     // read the spikehistory for a given point in time
     size_t n_incoming_cos_;
 
+    // number of incoming standard STDP connections, which read the spike
+    // history of nest::Archiving_Node
+    size_t n_incoming_std_;
+
     double tau_cos_;
 
     // Inverse of the learning rule tau
@@ -131,6 +193,10 @@ namespace mynest {
     // Exponent of the cos function
     double exponent_;
 
+    // Number of spikes between consecutive checkpoints of the trace in the
+    // history
+    long checkpoint_interval_;
+
     // Cos^2 accumulation variable
     double cos2_;
 
@@ -145,6 +211,87 @@ namespace mynest {
     // spiking history needed by stdp synapses
     std::deque<histentry_cos> history_cos_;
 
+    // State of the trace right after some of the spikes in the history. The
+    // state after any other spike is recomputed from the previous checkpoint.
+    // The oldest checkpoint is always at the first spike of the history.
+    std::deque<histcheckpoint_cos> checkpoints_cos_;
+
+    // Number of spikes stored since the last checkpoint
+    size_t spikes_since_checkpoint_;
+
+    // Remove the first spike of the history, keeping a checkpoint at the new
+    // first spike
+    void pop_cos_history();
+
+    // Insert a spike earlier than the last one in the history, and add it to
+    // the checkpoints after it
+    void insert_cos_history( long t_steps, float t_offset, unsigned int multiplicity );
+
+    // Step relative to which the times of the history are stored, so that
+    // they fit in 32 bits
+    long base_step_cos_;
+
+    // Time in ms of a time in steps relative to base_step_cos_
+    double steps_to_ms( unsigned int t_steps ) const
+    {
+      return nest::Time( nest::Time::step( this->base_step_cos_ + t_steps ) ).get_ms();
+    }
+
+    // Step (relative to base_step_cos_) and offset of a time in ms, with the
+    // convention of the spike events: t = step*h - offset, 0 <= offset < h
+    void to_history_stamp_cos( double t, long& t_steps, float& offset ) const
+    {
+      const nest::Time stamp = nest::Time( nest::Time::ms_stamp( t ) );
+      t_steps = stamp.get_steps() - this->base_step_cos_;
+      offset = ( stamp.get_tics() - nest::Time( nest::Time::ms( t ) ).get_tics() ) * nest::Time::get_ms_per_tic();
+    }
+
+    // Whether the time given by (t_steps, offset) is later than the time given
+    // by (other_steps, other_offset)
+    static bool is_later( long t_steps, float offset, long other_steps, float other_offset )
+    {
+      return t_steps > other_steps || ( t_steps == other_steps && offset < other_offset );
+    }
+
+    // Time of a new spike relative to base_step_cos_. The base is moved
+    // forward if the time does not fit in 32 bits
+    unsigned int to_history_steps_cos( long t_steps );
+
+    // Registrations whose marks have not been applied to the history yet, as
+    // (t_first_read, number of connections). They are applied in a single
+    // walk of the history before it is next pruned.
+    std::vector< std::pair< double, size_t > > pending_registrations_cos_;
+
+    void apply_pending_registrations_cos();
+
+    // Last result of get_cos_values, valid until the history or the
+    // parameters change
+    bool cache_valid_;
+    double cache_t_;
+    double cache_cos2_;
+    double cache_sin2_;
+    double cache_cossin_;
+
+    void compute_cos_values(double t, double& cos2, double& sin2, double& cossin);
+
+    // Presynaptic traces of the push-mode connections, stored as arrays so
+    // that the LTD of all of them is computed in a single vectorized sweep
+    // when a teaching spike arrives. Entry i belongs to the synapse with slot i.
+    std::vector<double> push_t_last_;
+    std::vector<float> push_cos2_;
+    std::vector<float> push_sin2_;
+    std::vector<float> push_cossin_;
+    std::vector<float> push_ltd_;
+
+    // Slots released by disconnected push-mode connections
+    std::vector<size_t> push_free_slots_;
+
+    // Time and multiplicity of the teaching spikes within the max delay
+    // before the last one, already swept by apply_push_ltd_cos
+    std::deque< std::pair< double, unsigned int > > push_recent_cs_;
+
+    void apply_push_ltd_cos(double t_cs, unsigned int multiplicity);
+
     void evolve_cos_values( double ElapsedTime, 
                           double oldcos2, double oldsin2, double oldcossin,
                           double& cos2, double& sin2, double& cossin);
@@ -29,8 +29,11 @@
 
 #include "archiving_node_cs.h"
 #include "dictutils.h"
+#include "exceptions.h"
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <limits>
 
 namespace nest
 {
@@ -48,27 +51,105 @@ namespace mynest {
 Archiving_Node_CS::Archiving_Node_CS() :
     Archiving_Node(),
 		n_incoming_cs_(0),
-    history_cs_()
+    n_incoming_std_(0),
+    history_cs_(),
+    base_step_cs_(0),
+    pending_registrations_cs_()
 		{
 		}
 
 Archiving_Node_CS::Archiving_Node_CS(const Archiving_Node_CS& n)
 : Archiving_Node(n),
 n_incoming_cs_(n.n_incoming_cs_),
-history_cs_()
+n_incoming_std_(n.n_incoming_std_),
+history_cs_(),
+base_step_cs_(0),
+pending_registrations_cs_()
   {}
 
 void Archiving_Node_CS::register_stdp_connection_cs(double t_first_read){
-  // Mark all entries in the deque, which we will not read in future as read by this input
-  // input, so that we savely increment the incoming number of
-  // connections afterwards without leaving spikes in the history.
-  // For details see bug #218. MH 08-04-22
-	for ( std::deque<histentry_cs>::iterator runner = history_cs_.begin();
-    runner != history_cs_.end() && runner->t_ <= t_first_read;
+  // The connection is counted right away, but marking the entries which
+  // it will not read is deferred, so that registering many connections
+  // (e.g., while connecting a projection) walks the history only once. The
+  // unmarked entries are just not pruned in the meantime. NEST creates every
+  // connection in the thread of its target, so these counters are never
+  // modified concurrently.
+  n_incoming_cs_++;
+
+  long t_first_read_steps;
+  float t_first_read_offset;
+  this->to_history_stamp_cs( t_first_read, t_first_read_steps, t_first_read_offset );
+
+  // There are no entries to be skipped by this connection
+  if ( history_cs_.empty() || is_later( history_cs_.front().t_steps_, history_cs_.front().offset_, t_first_read_steps, t_first_read_offset ) ){
+    return;
+  }
+
+  // Connections from the same source share t_first_read
+  if ( !pending_registrations_cs_.empty() && pending_registrations_cs_.back().first == t_first_read ){
+    pending_registrations_cs_.back().second++;
+  } else {
+    pending_registrations_cs_.push_back( std::make_pair( t_first_read, (size_t) 1 ) );
+  }
+}
+
+void Archiving_Node_CS::apply_pending_registrations_cs(){
+  if ( pending_registrations_cs_.empty() ){
+    return;
+  }
+
+  // Mark all entries in the deque, which the pending inputs will not read in
+  // future, as read by them. For details see bug #218. MH 08-04-22
+  std::sort( pending_registrations_cs_.begin(), pending_registrations_cs_.end() );
+
+  // Number of pending inputs with t_first_read >= t of the current entry
+  size_t n_marks = 0;
+  for ( std::vector< std::pair< double, size_t > >::const_iterator pending = pending_registrations_cs_.begin();
+    pending != pending_registrations_cs_.end();
+    ++pending ){
+    n_marks += pending->second;
+  }
+
+  std::vector< std::pair< double, size_t > >::const_iterator pending = pending_registrations_cs_.begin();
+  long pending_steps;
+  float pending_offset;
+  this->to_history_stamp_cs( pending->first, pending_steps, pending_offset );
+  for ( std::deque<histentry_cs>::iterator runner = history_cs_.begin();
+    runner != history_cs_.end() && n_marks > 0;
     ++runner){
-    (runner->access_counter_)++;
+    while ( n_marks > 0 && is_later( runner->t_steps_, runner->offset_, pending_steps, pending_offset ) ){
+      n_marks -= pending->second;
+      ++pending;
+      if ( pending != pending_registrations_cs_.end() ){
+        this->to_history_stamp_cs( pending->first, pending_steps, pending_offset );
+      }
+    }
+    runner->access_counter_ += n_marks;
+  }
+
+  pending_registrations_cs_.clear();
+}
+
+void Archiving_Node_CS::unregister_stdp_connection_cs(double t_last_read){
+  this->apply_pending_registrations_cs();
+
+  // Remove the marks of this input from the entries it has already read, so
+  // that they are not pruned before the remaining inputs read them
+  long t_last_read_steps;
+  float t_last_read_offset;
+  this->to_history_stamp_cs( t_last_read, t_last_read_steps, t_last_read_offset );
+  for ( std::deque<histentry_cs>::iterator runner = history_cs_.begin();
+    runner != history_cs_.end() && !is_later( runner->t_steps_, runner->offset_, t_last_read_steps, t_last_read_offset );
+    ++runner){
+    (runner->access_counter_)--;
+  }
+  n_incoming_cs_--;
+
+  // No input will read the history anymore
+  if (n_incoming_cs_ == 0){
+    history_cs_.clear();
+    pending_registrations_cs_.clear();
   }
-  n_incoming_cs_++;
 }
 
   void Archiving_Node_CS::get_cs_history(double t1, double t2,
@@ -80,10 +161,17 @@ void Archiving_Node_CS::register_stdp_connection_cs(double t_first_read){
       *start = *finish;
       return;
     } else {
+      // Times in the representation of the history. With on-grid spikes
+      // only the steps are compared
+      long t1_steps, t2_steps;
+      float t1_offset, t2_offset;
+      this->to_history_stamp_cs( t1, t1_steps, t1_offset );
+      this->to_history_stamp_cs( t2, t2_steps, t2_offset );
+
       std::deque<mynest::histentry_cs>::iterator runner = history_cs_.begin();
-      while ((runner != history_cs_.end()) && (runner->t_ <= t1)) ++runner;
+      while ((runner != history_cs_.end()) && !is_later(runner->t_steps_, runner->offset_, t1_steps, t1_offset)) ++runner;
       *start = runner;
-      while ((runner != history_cs_.end()) && (runner->t_ <= t2)) {
+      while ((runner != history_cs_.end()) && !is_later(runner->t_steps_, runner->offset_, t2_steps, t2_offset)) {
         (runner->access_counter_)++;
         ++runner;
   	  }
@@ -91,11 +179,11 @@ void Archiving_Node_CS::register_stdp_connection_cs(double t_first_read){
     }
   }
 
-  void mynest::Archiving_Node_CS::set_cs_spiketime(nest::Time const & t_sp, double offset)
+  void mynest::Archiving_Node_CS::set_cs_spiketime(nest::Time const & t_sp, unsigned int multiplicity, double offset)
   {
-    const double t_sp_ms = t_sp.get_ms() - offset;
-
     if (n_incoming_cs_){
+      this->apply_pending_registrations_cs();
+
       // prune all spikes from history which are no longer needed
       // except the penultimate one. we might still need it.
       while (history_cs_.size() > 1){
@@ -106,10 +194,94 @@ void Archiving_Node_CS::register_stdp_connection_cs(double t_first_read){
         }
       }  
 
-      history_cs_.push_back( histentry_cs( t_sp_ms, 0) );
+      // The spikes are not delivered in time order, since they arrive with
+      // different delays. A spike earlier than the last one is inserted at
+      // its position, which is at most the max delay before the end of the
+      // history
+      long t_steps = t_sp.get_steps() - base_step_cs_;
+      float t_offset = offset;
+      if ( !history_cs_.empty() && is_later( history_cs_.back().t_steps_, history_cs_.back().offset_, t_steps, t_offset ) ){
+        this->insert_cs_history( t_steps, t_offset, multiplicity );
+        return;
+      }
+
+      // Merge the spike into the last entry if it is at the same time and no
+      // input has read that entry yet
+      if ( !history_cs_.empty()
+        && history_cs_.back().t_steps_ == t_steps
+        && history_cs_.back().offset_ == t_offset
+        && history_cs_.back().access_counter_ == 0 ){
+        history_cs_.back().multiplicity_ += multiplicity;
+        return;
+      }
+
+      history_cs_.push_back( histentry_cs( this->to_history_steps_cs( base_step_cs_ + t_steps ), t_offset, multiplicity, 0) );
+    }
+  }
+
+
+  void Archiving_Node_CS::insert_cs_history( long t_steps, float t_offset, unsigned int multiplicity ){
+    // First entry later than the spike
+    std::deque<histentry_cs>::iterator next = history_cs_.end() - 1;
+    while ( next != history_cs_.begin()
+      && is_later( ( next - 1 )->t_steps_, ( next - 1 )->offset_, t_steps, t_offset ) ){
+      --next;
+    }
+
+    if ( next != history_cs_.begin()
+      && ( next - 1 )->t_steps_ == t_steps && ( next - 1 )->offset_ == t_offset ){
+      // The inputs which have already read the entry at the same time miss
+      // the spike
+      ( next - 1 )->multiplicity_ += multiplicity;
+      return;
+    }
+
+    // The times are stored relative to the first entry, so a spike earlier
+    // than the whole history is moved to the first entry
+    if ( t_steps < 0 ){
+      next->multiplicity_ += multiplicity;
+      return;
+    }
+
+    // The inputs which have read the next entry have gone past the time of
+    // the spike, and will not read it
+    const unsigned int access_counter = next->access_counter_;
+    history_cs_.insert( next, histentry_cs( t_steps, t_offset, multiplicity, access_counter ) );
+  }
+
+  unsigned int Archiving_Node_CS::to_history_steps_cs( long t_steps ){
+    if ( history_cs_.empty() ){
+      base_step_cs_ = t_steps;
+    } else if ( t_steps - base_step_cs_ > std::numeric_limits< unsigned int >::max() ){
+      // Move the base to the oldest spike in the history
+      const unsigned int shift = history_cs_.front().t_steps_;
+      for ( std::deque<histentry_cs>::iterator runner = history_cs_.begin();
+        runner != history_cs_.end();
+        ++runner){
+        runner->t_steps_ -= shift;
+      }
+      base_step_cs_ += shift;
+
+      if ( t_steps - base_step_cs_ > std::numeric_limits< unsigned int >::max() ){
+        throw nest::KernelException( "The teaching spike history spans too many steps." );
+      }
     }
+
+    return t_steps - base_step_cs_;
+  }
+
+  void Archiving_Node_CS::register_stdp_connection(double t_first_read){
+    n_incoming_std_++;
+    nest::Archiving_Node::register_stdp_connection(t_first_read);
   }
 
+  void Archiving_Node_CS::set_spiketime(nest::Time const & t_sp, double offset){
+    // Without standard STDP connections nobody reads the history and the
+    // K-minus traces, so they are not updated
+    if (n_incoming_std_){
+      nest::Archiving_Node::set_spiketime(t_sp, offset);
+    }
+  }
 
   void mynest::Archiving_Node_CS::get_status(DictionaryDatum & d) const
   {
@@ -136,6 +308,7 @@ void Archiving_Node_CS::register_stdp_connection_cs(double t_first_read){
   	Archiving_Node::clear_history();
 
   	history_cs_.clear();
+  	pending_registrations_cs_.clear();
   }
 
 } // of namespace nest
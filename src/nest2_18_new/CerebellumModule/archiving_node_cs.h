@@ -37,6 +37,8 @@
 #include "nest_time.h"
 #include "histentry_cs.h"
 #include <deque>
+#include <utility>
+#include <vector>
 
 #define DEBUG_ARCHIVER 1
 
@@ -83,12 +85,35 @@ namespace mynest {
     		  std::deque<histentry_cs>::iterator* finish);
 
     /**
-     * Register a new incoming STDP connection.
+     * Time (in ms) of a spike in the history.
+     */
+    double get_cs_time(const histentry_cs& entry) const
+    {
+      return nest::Time( nest::Time::step( this->base_step_cs_ + entry.t_steps_ ) ).get_ms() - entry.offset_;
+    }
+
+    /**
+     * Register a new incoming STDP connection. The entries it will not read are
+     * marked in a single walk of the history for all the connections registered
+     * before the next pruning.
      *
      * t_first_read: The newly registered synapse will read the history entries with t > t_first_read.
      */
     void register_stdp_connection_cs(double t_first_read);
 
+    /**
+     * Unregister an incoming STDP connection whose plasticity has been frozen.
+     *
+     * t_last_read: The synapse has read (or skipped) the history entries with t <= t_last_read.
+     */
+    void unregister_stdp_connection_cs(double t_last_read);
+
+    /**
+     * Register a new incoming standard STDP connection. The spike history of
+     * nest::Archiving_Node is only kept while the node has such connections.
+     */
+    void register_stdp_connection(double t_first_read);
+
     void get_status(DictionaryDatum & d) const;
     void set_status(const DictionaryDatum & d);
 
@@ -96,9 +121,17 @@ namespace mynest {
 
   /**
    * \fn void set_spiketime(Time const & t_sp)
-   * record spike history
+   * record spike history. Spikes at the same time are stored in one
+   * entry with their multiplicity.
+   */
+  void set_cs_spiketime(nest::Time const & t_sp, unsigned int multiplicity=1, double offset=0.0);
+
+  /**
+   * \fn void set_spiketime(Time const & t_sp)
+   * record spike history of nest::Archiving_Node, if a standard STDP
+   * connection needs it
    */
-  void set_cs_spiketime(nest::Time const & t_sp, double offset=0);
+  void set_spiketime(nest::Time const & t_sp, double offset=0.0);
 
   /**
    * \fn void clear_history()
@@ -114,11 +147,49 @@ namespace mynest {
     // read the spikehistory for a given point in time
     size_t n_incoming_cs_;
 
+    // number of incoming standard STDP connections, which read the spike
+    // history of nest::Archiving_Node
+    size_t n_incoming_std_;
+
     // Accumulation variables
     
     // spiking history needed by stdp synapses
     std::deque<histentry_cs> history_cs_;
 
+    // Step relative to which the times of the history are stored, so that
+    // they fit in 32 bits
+    long base_step_cs_;
+
+    // Step (relative to base_step_cs_) and offset of a time in ms, with the
+    // convention of the spike events: t = step*h - offset, 0 <= offset < h
+    void to_history_stamp_cs( double t, long& t_steps, float& offset ) const
+    {
+      const nest::Time stamp = nest::Time( nest::Time::ms_stamp( t ) );
+      t_steps = stamp.get_steps() - this->base_step_cs_;
+      offset = ( stamp.get_tics() - nest::Time( nest::Time::ms( t ) ).get_tics() ) * nest::Time::get_ms_per_tic();
+    }
+
+    // Whether the time given by (t_steps, offset) is later than the time given
+    // by (other_steps, other_offset)
+    static bool is_later( long t_steps, float offset, long other_steps, float other_offset )
+    {
+      return t_steps > other_steps || ( t_steps == other_steps && offset < other_offset );
+    }
+
+    // Time of a new spike relative to base_step_cs_. The base is moved
+    // forward if the time does not fit in 32 bits
+    unsigned int to_history_steps_cs( long t_steps );
+
+    // Insert a spike earlier than the last one in the history
+    void insert_cs_history( long t_steps, float t_offset, unsigned int multiplicity );
+
+    // Registrations whose marks have not been applied to the history yet, as
+    // (t_first_read, number of connections). They are applied in a single
+    // walk of the history before it is next pruned.
+    std::vector< std::pair< double, size_t > > pending_registrations_cs_;
+
+    void apply_pending_registrations_cs();
+
 };
   
 } // of namespace
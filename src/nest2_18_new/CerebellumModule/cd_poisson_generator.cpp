@@ -21,6 +21,8 @@
 #include "dictutils.h"
 #include "doubledatum.h"
 
+#include <algorithm>
+
 
 /* ---------------------------------------------------------------- 
  * Recordables map
@@ -29,6 +31,13 @@
 nest::RecordablesMap<mynest::cd_poisson_generator> mynest::cd_poisson_generator::recordablesMap_;
 
 
+namespace
+{
+  const uint32_t INPUT_TRACE_MAGIC = 0x53544243;
+  const uint32_t INPUT_TRACE_VERSION = 1;
+  const size_t INPUT_TRACE_HEADER_SIZE = 64;
+}
+
 namespace nest  // template specialization must be placed in namespace
 {
   // Override the create() method with one call to RecordablesMap::insert_() 
@@ -52,6 +61,12 @@ namespace nest  // template specialization must be placed in namespace
       const Name max_current("max_current");
       const Name min_rate("min_rate");
       const Name max_rate("max_rate");
+      const Name exponential_intervals("exponential_intervals");
+      const Name counter_rng("counter_rng");
+      const Name rng_seed("rng_seed");
+      const Name input_column("input_column");
+      const Name input_period("input_period");
+      const Name input_type("input_type");
   }
 }
 
@@ -65,6 +80,14 @@ mynest::cd_poisson_generator::Parameters_::Parameters_()
    , max_rate_( 10.0 ) // Hz
    , min_current_( 0.0 ) // nA
    , max_current_( 1.0 ) // nA
+   , individual_spike_trains_( false )
+   , exponential_intervals_( false )
+   , counter_rng_( false )
+   , rng_seed_( 0 )
+   , input_file_()
+   , input_column_( 0 )
+   , input_period_( 1.0 ) // ms
+   , input_type_( CURRENT_INPUT )
 {
 }
 
@@ -90,6 +113,14 @@ void mynest::cd_poisson_generator::Parameters_::get(DictionaryDatum &d) const
   def< double >( d, nest::names::max_rate, max_rate_ );
   def< double >( d, nest::names::min_current, min_current_ );
   def< double >( d, nest::names::max_current, max_current_ );
+  def< bool >( d, nest::names::individual_spike_trains, individual_spike_trains_ );
+  def< bool >( d, nest::names::exponential_intervals, exponential_intervals_ );
+  def< bool >( d, nest::names::counter_rng, counter_rng_ );
+  def< long >( d, nest::names::rng_seed, rng_seed_ );
+  def< std::string >( d, nest::names::input_file, input_file_ );
+  def< long >( d, nest::names::input_column, input_column_ );
+  def< double >( d, nest::names::input_period, input_period_ );
+  def< std::string >( d, nest::names::input_type, input_type_ == RATE_INPUT ? "rate" : "current" );
 }
 
 void mynest::cd_poisson_generator::Parameters_::set(const DictionaryDatum& d)
@@ -98,10 +129,51 @@ void mynest::cd_poisson_generator::Parameters_::set(const DictionaryDatum& d)
   updateValue< double >( d, nest::names::max_rate, max_rate_ );
   updateValue< double >( d, nest::names::min_current, min_current_ );
   updateValue< double >( d, nest::names::max_current, max_current_ );
+  updateValue< bool >( d, nest::names::individual_spike_trains, individual_spike_trains_ );
+  updateValue< bool >( d, nest::names::exponential_intervals, exponential_intervals_ );
+  updateValue< bool >( d, nest::names::counter_rng, counter_rng_ );
+  updateValue< long >( d, nest::names::rng_seed, rng_seed_ );
+  updateValue< std::string >( d, nest::names::input_file, input_file_ );
+  updateValue< long >( d, nest::names::input_column, input_column_ );
+  updateValue< double >( d, nest::names::input_period, input_period_ );
+
+  std::string input_type;
+  if ( updateValue< std::string >( d, nest::names::input_type, input_type ) )
+  {
+    if ( input_type == "current" )
+    {
+      input_type_ = CURRENT_INPUT;
+    }
+    else if ( input_type == "rate" )
+    {
+      input_type_ = RATE_INPUT;
+    }
+    else
+    {
+      throw nest::BadProperty( "The input_type parameter must be \"current\" or \"rate\"." );
+    }
+  }
+
   if ( min_rate_ < 0 || max_rate_ < 0)
   {
     throw nest::BadProperty( "The min_rate and max_rate parameters cannot be negative." );
   }
+  if ( individual_spike_trains_ && exponential_intervals_ )
+  {
+    throw nest::BadProperty( "exponential_intervals cannot be combined with individual_spike_trains." );
+  }
+  if ( rng_seed_ < 0 || rng_seed_ > 4294967295L )
+  {
+    throw nest::BadProperty( "The rng_seed parameter must be in [0, 2^32 - 1]." );
+  }
+  if ( input_column_ < 0 )
+  {
+    throw nest::BadProperty( "The input_column parameter cannot be negative." );
+  }
+  if ( input_period_ <= 0 )
+  {
+    throw nest::BadProperty( "The input_period parameter must be strictly positive." );
+  }
 }
 
 void mynest::cd_poisson_generator::State_::get(DictionaryDatum &d) const
@@ -143,6 +215,7 @@ mynest::cd_poisson_generator::cd_poisson_generator()
   , B_(*this)
 {
   recordablesMap_.create();
+  V_.input_data_ = 0;
 }
 
 mynest::cd_poisson_generator::cd_poisson_generator(const cd_poisson_generator& n)
@@ -151,6 +224,7 @@ mynest::cd_poisson_generator::cd_poisson_generator(const cd_poisson_generator& n
   , S_( n.S_)
   , B_( n.B_, *this)
 {
+  V_.input_data_ = 0;
 }
 
 mynest::cd_poisson_generator::~cd_poisson_generator()
@@ -175,29 +249,86 @@ void mynest::cd_poisson_generator::init_buffers_()
   B_.logger_.reset();
 
   B_.step_ = nest::Time::get_resolution().get_ms();
+  V_.sampler_.reset();
+}
+
+double mynest::cd_poisson_generator::compute_rate_() const
+{
+  return PoissonSampler::current_to_rate( S_.input_current_, P_.min_current_, P_.max_current_,
+    P_.min_rate_, P_.max_rate_ );
 }
 
 void mynest::cd_poisson_generator::calibrate()
 {
   B_.logger_.init();
 
-  double rate = 0.0;
+  set_rate_( compute_rate_() );
 
-  if (S_.input_current_<=P_.min_current_){
-    rate = P_.min_rate_;
-  } else {
-    if (S_.input_current_>=P_.max_current_){
-      rate = P_.max_rate_;
-    } else {
-      rate = (S_.input_current_-P_.min_current_)/(P_.max_current_-P_.min_current_)
-      *(P_.max_rate_-P_.min_rate_)+P_.min_rate_;
-    }
+  V_.sampler_.set_counter_rng( P_.counter_rng_, get_gid(), P_.rng_seed_ );
+
+  map_input_file_();
+}
+
+void mynest::cd_poisson_generator::map_input_file_()
+{
+  V_.input_data_ = 0;
+
+  if ( P_.input_file_.empty() )
+  {
+    V_.input_map_.reset();
+    return;
   }
 
-  S_.rate_ = rate;
+  if ( !V_.input_map_ || V_.input_map_->path() != P_.input_file_ )
+  {
+    V_.input_map_ = MappedFile::shared( P_.input_file_ );
+  }
 
-  V_.poisson_dev_.set_lambda(
-        nest::Time::get_resolution().get_ms() * S_.rate_ * 1e-3 );
+  const MappedFile& file = *V_.input_map_;
+  const uint32_t* header = reinterpret_cast< const uint32_t* >( file.data() );
+  if ( file.size() < INPUT_TRACE_HEADER_SIZE || header[ 0 ] != INPUT_TRACE_MAGIC
+    || header[ 1 ] != INPUT_TRACE_VERSION )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " is not an input trace file." ).c_str() );
+  }
+
+  V_.input_columns_ = header[ 2 ];
+  if ( P_.input_column_ >= static_cast< long >( V_.input_columns_ ) )
+  {
+    throw nest::BadProperty( "The input_column parameter is beyond the columns of the input file." );
+  }
+
+  V_.input_samples_ = ( file.size() - INPUT_TRACE_HEADER_SIZE ) / ( V_.input_columns_ * sizeof( double ) );
+  if ( V_.input_samples_ == 0 )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " does not contain any sample." ).c_str() );
+  }
+
+  V_.input_data_ =
+    reinterpret_cast< const double* >( file.data() + INPUT_TRACE_HEADER_SIZE ) + P_.input_column_;
+  V_.samples_per_step_ = B_.step_ / P_.input_period_;
+}
+
+double mynest::cd_poisson_generator::replayed_value_(long step) const
+{
+  const double x = step * V_.samples_per_step_;
+  const size_t k = static_cast< size_t >( x );
+
+  // The last value is held after the end of the traces
+  if ( k + 1 >= V_.input_samples_ )
+  {
+    return V_.input_data_[ ( V_.input_samples_ - 1 ) * V_.input_columns_ ];
+  }
+
+  const double v0 = V_.input_data_[ k * V_.input_columns_ ];
+  const double v1 = V_.input_data_[ ( k + 1 ) * V_.input_columns_ ];
+  return v0 + ( x - k ) * ( v1 - v0 );
+}
+
+void mynest::cd_poisson_generator::set_rate_(double rate)
+{
+  S_.rate_ = rate;
+  V_.sampler_.set_rate( rate, B_.step_ );
 }
 
 /* ---------------------------------------------------------------- 
@@ -217,34 +348,43 @@ void mynest::cd_poisson_generator::update(nest::Time const & T, const long from,
   {
     double new_current = B_.currents_.get_value(lag);
 
-    // Update the firing rate only when the input current changes
-    if (S_.input_current_!= new_current){
+    if (V_.input_data_ != 0 && P_.input_type_ == Parameters_::CURRENT_INPUT){
+      new_current += replayed_value_( T.get_steps() + lag );
+    }
 
+    if (V_.input_data_ != 0 && P_.input_type_ == Parameters_::RATE_INPUT){
+      // The replayed rate replaces the rate given by the currents
       S_.input_current_ = new_current;
-      
-      double rate = 0.0;
-
-      if (S_.input_current_<=P_.min_current_){
-        rate = P_.min_rate_;
-      } else {
-        if (S_.input_current_>=P_.max_current_){
-          rate = P_.max_rate_;
-        } else {
-          rate = (S_.input_current_-P_.min_current_)/(P_.max_current_-P_.min_current_)
-          *(P_.max_rate_-P_.min_rate_)+P_.min_rate_;
-        }
+
+      const double rate = std::max( 0.0, replayed_value_( T.get_steps() + lag ) );
+      if (S_.rate_ != rate){
+        set_rate_( rate );
       }
+    } else if (S_.input_current_!= new_current){
+      // Update the firing rate only when the input current changes
 
-      S_.rate_ = rate;
+      S_.input_current_ = new_current;
 
-      // Lambda device frequency is updated only once per call to update.
-      V_.poisson_dev_.set_lambda(
-        nest::Time::get_resolution().get_ms() * S_.rate_ * 1e-3 );
+      set_rate_( compute_rate_() );
     }
 
       
-    if (S_.rate_ > 0.0){
-      long n_spikes = V_.poisson_dev_.ldev( rng );
+    if (P_.exponential_intervals_){
+      const long n_spikes = V_.sampler_.interval_spikes( rng );
+
+      if ( n_spikes > 0 ) // we must not send events with multiplicity 0
+      {
+        nest::SpikeEvent e;
+        e.set_multiplicity( n_spikes );
+        nest::kernel().event_delivery_manager.send( *this, e, lag );
+      }
+    } else if (S_.rate_ > 0.0 && P_.individual_spike_trains_){
+      // The spikes of every target are drawn in event_hook
+      B_.current_step_ = T.get_steps() + lag;
+      nest::DSSpikeEvent e;
+      nest::kernel().event_delivery_manager.send( *this, e, lag );
+    } else if (S_.rate_ > 0.0){
+      const long n_spikes = V_.sampler_.poisson_spikes( T.get_steps() + lag, rng );
 
       if ( n_spikes > 0 ) // we must not send events with multiplicity 0
       {
@@ -261,6 +401,18 @@ void mynest::cd_poisson_generator::update(nest::Time const & T, const long from,
   
 
   
+}
+
+void mynest::cd_poisson_generator::event_hook(nest::DSSpikeEvent& e)
+{
+  librandom::RngPtr rng = nest::kernel().rng_manager.get_rng( get_thread() );
+  const long n_spikes = V_.sampler_.target_spikes( B_.current_step_, e.get_receiver().get_gid(), e.get_port(), rng );
+
+  if ( n_spikes > 0 ) // we must not send events with multiplicity 0
+  {
+    e.set_multiplicity( n_spikes );
+    e.get_receiver().handle( e );
+  }
 }
 
 void mynest::cd_poisson_generator::handle(nest::CurrentEvent& e)
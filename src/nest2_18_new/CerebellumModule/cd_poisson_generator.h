@@ -9,9 +9,6 @@
 #ifndef CD_POISSON_GENERATOR_H
 #define CD_POISSON_GENERATOR_H
 
-// Includes from librandom:
-#include "poisson_randomdev.h"
-
 // Includes from nestkernel:
 #include "connection.h"
 #include "event.h"
@@ -21,16 +18,23 @@
 #include "ring_buffer.h"
 #include "universal_data_logger.h"
 
+#include "mapped_file.h"
+#include "poisson_sampler.h"
+
+#include <memory>
+#include <string>
+
 /* BeginDocumentation
 Name: cd_poisson_generator - simulate neuron firing with Poisson processes
                           statistics drive by input current.
 Description:
   The cd_poisson_generator simulates a neuron that is firing with Poisson
   statistics, i.e. exponentially distributed interspike intervals. Its firing
-  rate is linearly calculated based on the total amount of input current. It will
-  generate a _unique_ spike train for each of it's targets. If you do not want
-  this behavior and need the same spike train for all targets, you have to use a
-  parrot neuron inbetween the poisson generator and the targets.
+  rate is linearly calculated based on the total amount of input current. By
+  default, all the targets receive the same spike train. With
+  individual_spike_trains, every target receives its own independent spike
+  train at the same rate, so a single generator can drive a whole population
+  of mossy fibers without one generator and parrot neuron per fiber.
 
 Parameters:
    The following parameters appear in the element's status dictionary:
@@ -44,6 +48,22 @@ Parameters:
                       current is below this parameter.
    max_current    double - The firing rate will be max_rate when the input
                       current is above this parameter.
+   individual_spike_trains bool - Draw an independent spike train for every
+                      target (default: false).
+   exponential_intervals   bool - Draw the time of the next spike from the
+                      exponential interspike interval distribution instead of
+                      drawing a Poisson count every step (default: false).
+   counter_rng    bool - Draw the random numbers from a counter-based
+                      generator keyed by the generator id instead of the
+                      random generator of the thread (default: false).
+   rng_seed       int  - Seed of the counter-based generator (default: 0).
+   input_file     string - Binary file with the input traces to replay
+                      (default: none).
+   input_column   int  - Column of the trace of this generator (default: 0).
+   input_period   double - Time between two samples of the traces in ms
+                      (default: 1.0).
+   input_type     string - "current" to replay the input current, or "rate"
+                      to replay the firing rate in Hz (default: "current").
 
 Sends: SpikeEvent
 
@@ -53,6 +73,43 @@ Remarks:
    not actually send out n spikes. Instead, it emits a single spike with
    n-fold synaptic weight for the sake of efficiency.
 
+   individual_spike_trains must be set before the generator is connected.
+   As with poisson_generator, the independent trains can only be sent through
+   synapse models that support DSSpikeEvent, such as static_synapse.
+
+   With exponential_intervals, random numbers are only drawn when a spike is
+   emitted, instead of every step, which is much cheaper at low rates. The
+   spikes are placed by time rescaling: every interval is drawn as a number
+   of expected spikes, which the rate of every step consumes, so a change of
+   the rate (e.g. of a replayed rate trace) does not draw any number. It
+   cannot be combined with individual_spike_trains.
+
+   With counter_rng, every random number is a function of rng_seed, the id
+   of the generator and the time step (or the number of intervals drawn so
+   far), so the spike trains are the same for any number of threads and
+   processes. The numbers are produced four at a time by the Philox4x32-10
+   generator. In individual_spike_trains mode, the train of every target is
+   keyed by the id of the target, so a target connected several times
+   receives the same train through every connection. The four numbers of a
+   block are used in four consecutive steps of the same target.
+
+   With input_file, the generator replays a recorded trace, e.g. a
+   trajectory of the robot arm for offline training, without any transfer
+   from Python during the simulation. The file has a header of 64 bytes
+
+     uint32 magic       - 0x53544243 ("CBTS" in little endian)
+     uint32 version     - 1
+     uint32 num_columns - Number of traces
+     (52 bytes of padding)
+
+   followed by the samples as doubles, one row per sample and one column per
+   generator. The sample k is taken at k * input_period ms, and the value
+   between two samples is interpolated linearly. After the last sample, the
+   last value is held. The file is mapped once and shared by all the
+   generators that read it, so only the pages being replayed are loaded in
+   memory. A replayed current is added to the currents received as
+   CurrentEvents. A replayed rate replaces the rate given by the currents.
+
 SeeAlso: poisson_generator, Device, parrot_neuron
 */
 
@@ -66,6 +123,13 @@ namespace nest
     	extern const Name max_rate;  
       extern const Name min_current;
       extern const Name max_current;
+      extern const Name exponential_intervals;
+      extern const Name counter_rng;
+      extern const Name rng_seed;
+      extern const Name input_file;
+      extern const Name input_column;
+      extern const Name input_period;
+      extern const Name input_type;
     }
 }
 
@@ -108,6 +172,8 @@ namespace mynest
 
     nest::port send_test_event(nest::Node&, nest::rport, nest::synindex, bool);
 
+    using nest::Node::event_hook;
+
     void handle(nest::CurrentEvent &);
     void handle(nest::DataLoggingRequest &); 
     
@@ -124,6 +190,23 @@ namespace mynest
     void calibrate();
     
     void update(nest::Time const &, const long, const long);
+
+    /**
+     * Draw the spikes of a single target in individual_spike_trains mode.
+     */
+    void event_hook(nest::DSSpikeEvent&);
+
+    // Firing rate in Hz for the current input current
+    double compute_rate_() const;
+
+    // Update the Poisson parameters after a change in the firing rate
+    void set_rate_(double rate);
+
+    // Map the input file and check its header
+    void map_input_file_();
+
+    // Value of the replayed trace at the beginning of a step
+    double replayed_value_(long step) const;
     
     // END Boilerplate function declarations ----------------------------
 
@@ -142,6 +225,35 @@ namespace mynest
       double max_rate_;
       double min_current_;
       double max_current_;
+
+      //! Send an independent spike train to every target
+      bool individual_spike_trains_;
+
+      //! Sample the interspike intervals instead of the counts per step
+      bool exponential_intervals_;
+
+      //! Use the counter-based generator instead of the thread generator
+      bool counter_rng_;
+
+      //! Seed of the counter-based generator
+      long rng_seed_;
+
+      //! File of the replayed traces, or empty
+      std::string input_file_;
+
+      //! Column of the trace of this generator
+      long input_column_;
+
+      //! Time between two samples in ms
+      double input_period_;
+
+      //! Quantity in the replayed trace
+      enum InputTypes
+      {
+        CURRENT_INPUT = 0,
+        RATE_INPUT
+      };
+      InputTypes input_type_;
       
       Parameters_(); //!< Sets default parameter values
 
@@ -192,13 +304,26 @@ namespace mynest
       // step_, and the resolution cannot change after nodes have been created,
       // it is safe to place both here.
       double step_;           //!< step size in ms
+
+      //! Step of the event being delivered in individual_spike_trains mode
+      long current_step_;
     };
 
   // ------------------------------------------------------------
 
     struct Variables_
     {
-      librandom::PoissonRandomDev poisson_dev_; //!< Random deviate generator
+      PoissonSampler sampler_; //!< Spike counts for the firing rate
+
+      //! Mapping of the input file, shared with the other generators
+      std::shared_ptr< const MappedFile > input_map_;
+
+      //! First sample of the trace of this generator, or 0 without input file
+      const double* input_data_;
+
+      size_t input_columns_;         //!< Number of columns of the file
+      size_t input_samples_;         //!< Number of samples of the traces
+      double samples_per_step_;      //!< Simulation step in sample periods
     };
 
     // Access functions for UniversalDataLogger -------------------------------
@@ -225,6 +350,15 @@ namespace mynest
   inline
   nest::port cd_poisson_generator::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex syn_id, bool dummy_target)
   {
+    // The dummy target tells whether the synapse model supports
+    // DSSpikeEvent, which carries the individual spike trains
+    if ( dummy_target && P_.individual_spike_trains_ )
+    {
+      nest::DSSpikeEvent e;
+      e.set_sender( *this );
+      return target.handles_test_event( e, receptor_type );
+    }
+
   	nest::SpikeEvent e;
     e.set_sender( *this );
     return target.handles_test_event( e, receptor_type );
@@ -0,0 +1,269 @@
+/*
+ *  cd_poisson_neuron.cpp
+ *
+ *  This file is based on the poisson generator and parrot neuron models
+ *  distributed with NEST.
+ */
+
+#include "cd_poisson_neuron.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+#include "universal_data_logger_impl.h"
+
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+
+
+/* ----------------------------------------------------------------
+ * Recordables map
+ * ---------------------------------------------------------------- */
+
+nest::RecordablesMap<mynest::cd_poisson_neuron> mynest::cd_poisson_neuron::recordablesMap_;
+
+
+namespace nest  // template specialization must be placed in namespace
+{
+  // Override the create() method with one call to RecordablesMap::insert_()
+  // for each quantity to be recorded.
+  template <>
+  void RecordablesMap<mynest::cd_poisson_neuron>::create()
+  {
+    // use standard names whereever you can for consistency!
+    insert_(names::rate,
+    &mynest::cd_poisson_neuron::get_rate_);
+
+    // use standard names whereever you can for consistency!
+    insert_(names::I,
+    &mynest::cd_poisson_neuron::get_current_);
+  }
+}
+
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::cd_poisson_neuron::Parameters_::Parameters_()
+   : min_rate_( 1.0 ) // Hz
+   , max_rate_( 10.0 ) // Hz
+   , min_current_( 0.0 ) // nA
+   , max_current_( 1.0 ) // nA
+   , exponential_intervals_( false )
+   , counter_rng_( false )
+   , rng_seed_( 0 )
+{
+}
+
+mynest::cd_poisson_neuron::State_::State_(const Parameters_& p)
+  : rate_(5.0),
+  input_current_(0.0)
+{
+}
+
+mynest::cd_poisson_neuron::State_::State_(const State_& s)
+  : rate_(s.rate_),
+  input_current_(s.input_current_)
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extractions and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void mynest::cd_poisson_neuron::Parameters_::get(DictionaryDatum &d) const
+{
+  def< double >( d, nest::names::min_rate, min_rate_ );
+  def< double >( d, nest::names::max_rate, max_rate_ );
+  def< double >( d, nest::names::min_current, min_current_ );
+  def< double >( d, nest::names::max_current, max_current_ );
+  def< bool >( d, nest::names::exponential_intervals, exponential_intervals_ );
+  def< bool >( d, nest::names::counter_rng, counter_rng_ );
+  def< long >( d, nest::names::rng_seed, rng_seed_ );
+}
+
+void mynest::cd_poisson_neuron::Parameters_::set(const DictionaryDatum& d)
+{
+  updateValue< double >( d, nest::names::min_rate, min_rate_ );
+  updateValue< double >( d, nest::names::max_rate, max_rate_ );
+  updateValue< double >( d, nest::names::min_current, min_current_ );
+  updateValue< double >( d, nest::names::max_current, max_current_ );
+  updateValue< bool >( d, nest::names::exponential_intervals, exponential_intervals_ );
+  updateValue< bool >( d, nest::names::counter_rng, counter_rng_ );
+  updateValue< long >( d, nest::names::rng_seed, rng_seed_ );
+  if ( min_rate_ < 0 || max_rate_ < 0)
+  {
+    throw nest::BadProperty( "The min_rate and max_rate parameters cannot be negative." );
+  }
+  if ( rng_seed_ < 0 || rng_seed_ > 4294967295L )
+  {
+    throw nest::BadProperty( "The rng_seed parameter must be in [0, 2^32 - 1]." );
+  }
+}
+
+void mynest::cd_poisson_neuron::State_::get(DictionaryDatum &d) const
+{
+  def<double>(d, nest::names::rate, rate_);
+  def<double>(d, nest::names::I, input_current_);
+}
+
+void mynest::cd_poisson_neuron::State_::set(const DictionaryDatum& d, const Parameters_&)
+{
+  updateValue<double>(d, nest::names::rate, rate_);
+  updateValue<double>(d, nest::names::I, input_current_);
+}
+
+mynest::cd_poisson_neuron::Buffers_::Buffers_(mynest::cd_poisson_neuron& n)
+  : logger_(n)
+{
+  // Initialization of the remaining members is deferred to
+  // init_buffers_().
+}
+
+mynest::cd_poisson_neuron::Buffers_::Buffers_(const Buffers_&, cd_poisson_neuron& n)
+  : logger_(n)
+{
+  // Initialization of the remaining members is deferred to
+  // init_buffers_().
+}
+
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node, and destructor
+ * ---------------------------------------------------------------- */
+
+mynest::cd_poisson_neuron::cd_poisson_neuron()
+  : Archiving_Node()
+  , P_()
+  , S_(P_)
+  , B_(*this)
+{
+  recordablesMap_.create();
+}
+
+mynest::cd_poisson_neuron::cd_poisson_neuron(const cd_poisson_neuron& n)
+  : Archiving_Node( n )
+  , P_( n.P_ )
+  , S_( n.S_)
+  , B_( n.B_, *this)
+{
+}
+
+mynest::cd_poisson_neuron::~cd_poisson_neuron()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void mynest::cd_poisson_neuron::init_state_(const Node& proto)
+{
+  const cd_poisson_neuron& pr = downcast< cd_poisson_neuron >( proto );
+
+  S_ = pr.S_;
+}
+
+void mynest::cd_poisson_neuron::init_buffers_()
+{
+  B_.currents_.clear();
+  nest::Archiving_Node::clear_history();
+
+  B_.logger_.reset();
+
+  B_.step_ = nest::Time::get_resolution().get_ms();
+  V_.sampler_.reset();
+}
+
+double mynest::cd_poisson_neuron::compute_rate_() const
+{
+  return PoissonSampler::current_to_rate( S_.input_current_, P_.min_current_, P_.max_current_,
+    P_.min_rate_, P_.max_rate_ );
+}
+
+void mynest::cd_poisson_neuron::calibrate()
+{
+  B_.logger_.init();
+
+  set_rate_( compute_rate_() );
+
+  V_.sampler_.set_counter_rng( P_.counter_rng_, get_gid(), P_.rng_seed_ );
+}
+
+void mynest::cd_poisson_neuron::set_rate_(double rate)
+{
+  S_.rate_ = rate;
+  V_.sampler_.set_rate( rate, B_.step_ );
+}
+
+/* ----------------------------------------------------------------
+ * Update and spike handling functions
+ * ---------------------------------------------------------------- */
+
+void mynest::cd_poisson_neuron::update(nest::Time const & T, const long from, const long to)
+{
+
+  assert(
+    to >= 0 && ( nest::delay ) from < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  librandom::RngPtr rng = nest::kernel().rng_manager.get_rng( get_thread() );
+
+  for ( long lag = from; lag < to; ++lag)
+  {
+    double new_current = B_.currents_.get_value(lag);
+
+    // Update the firing rate only when the input current changes
+    if (S_.input_current_!= new_current){
+
+      S_.input_current_ = new_current;
+
+      set_rate_( compute_rate_() );
+    }
+
+    long n_spikes = 0;
+
+    if (P_.exponential_intervals_){
+      n_spikes = V_.sampler_.interval_spikes( rng );
+    } else if (S_.rate_ > 0.0){
+      n_spikes = V_.sampler_.poisson_spikes( T.get_steps() + lag, rng );
+    }
+
+    if ( n_spikes > 0 ) // we must not send events with multiplicity 0
+    {
+      nest::SpikeEvent e;
+      e.set_multiplicity( n_spikes );
+      nest::kernel().event_delivery_manager.send( *this, e, lag );
+
+      // set the spike times, respecting the multiplicity
+      for ( long i = 0; i < n_spikes; ++i )
+        set_spiketime( nest::Time::step( T.get_steps() + lag + 1 ) );
+    }
+
+    // log state data
+    B_.logger_.record_data(T.get_steps() + lag);
+  }
+}
+
+void mynest::cd_poisson_neuron::handle(nest::CurrentEvent& e)
+{
+  assert(e.get_delay_steps() > 0);
+
+  const double c=e.get_current();
+  const double w=e.get_weight();
+
+  // add weighted current; HEP 2002-10-04
+  B_.currents_.add_value(e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin()),
+          w *c);
+}
+
+void mynest::cd_poisson_neuron::handle(nest::DataLoggingRequest& e)
+{
+  B_.logger_.handle(e);
+}
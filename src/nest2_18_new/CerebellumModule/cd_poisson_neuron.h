@@ -0,0 +1,284 @@
+/*
+ *  cd_poisson_neuron.h
+ *
+ *  This file is based on the poisson generator and parrot neuron models
+ *  distributed with NEST.
+ */
+
+#ifndef CD_POISSON_NEURON_H
+#define CD_POISSON_NEURON_H
+
+// Includes from nestkernel:
+#include "archiving_node.h"
+#include "connection.h"
+#include "event.h"
+#include "nest_types.h"
+#include "ring_buffer.h"
+#include "universal_data_logger.h"
+
+#include "poisson_sampler.h"
+
+/* BeginDocumentation
+Name: cd_poisson_neuron - Neuron firing with Poisson statistics driven by
+                          input current.
+Description:
+  The cd_poisson_neuron fires with Poisson statistics at the rate given by
+  its input current, exactly as cd_poisson_generator. It is a neuron instead
+  of a device, so it can be the source of plastic synapses and its spikes are
+  delivered as those of any other neuron. It replaces the pair of a
+  cd_poisson_generator and a parrot_neuron in front of the plastic synapses.
+  All the targets receive the same spike train.
+
+Parameters:
+   The following parameters appear in the element's status dictionary:
+
+   min_rate double - Min firing rate in Hz
+   max_rate double - Max firing rate in Hz
+   min_current    double - The firing rate will be min_rate when the input
+                      current is below this parameter.
+   max_current    double - The firing rate will be max_rate when the input
+                      current is above this parameter.
+   exponential_intervals   bool - Draw the time of the next spike from the
+                      exponential interspike interval distribution instead of
+                      drawing a Poisson count every step (default: false).
+   counter_rng    bool - Draw the random numbers from a counter-based
+                      generator keyed by the neuron id instead of the random
+                      generator of the thread (default: false).
+   rng_seed       int  - Seed of the counter-based generator (default: 0).
+
+Sends: SpikeEvent
+
+Receives: CurrentEvent, DataLoggingRequest
+
+Remarks:
+   Several spikes in the same step are sent as a single spike with
+   multiplicity, and all of them are stored in the spike history, as the
+   parrot_neuron does.
+
+   With counter_rng, the spike train is the same for any number of threads
+   and processes, as in cd_poisson_generator.
+
+SeeAlso: cd_poisson_generator, parrot_neuron
+*/
+
+// Define name constants for state variables and parameters
+namespace nest
+{
+	namespace names
+	{
+    	// Neuron parameters
+    	extern const Name min_rate;
+    	extern const Name max_rate;
+      extern const Name min_current;
+      extern const Name max_current;
+      extern const Name exponential_intervals;
+      extern const Name counter_rng;
+      extern const Name rng_seed;
+    }
+}
+
+namespace mynest
+{
+  class cd_poisson_neuron : public nest::Archiving_Node
+  {
+
+  public:
+
+    cd_poisson_neuron();
+    cd_poisson_neuron(const cd_poisson_neuron&);
+    ~cd_poisson_neuron();
+
+
+    /**
+     * Import sets of overloaded virtual functions.
+     * We need to explicitly include sets of overloaded
+     * virtual functions into the current scope.
+     * According to the SUN C++ FAQ, this is the correct
+     * way of doing things, although all other compilers
+     * happily live without.
+     */
+
+    using nest::Node::handles_test_event;
+    using nest::Node::handle;
+
+    nest::port send_test_event(nest::Node&, nest::rport, nest::synindex, bool);
+
+    void handle(nest::CurrentEvent &);
+    void handle(nest::DataLoggingRequest &);
+
+    nest::port handles_test_event(nest::CurrentEvent &, nest::rport);
+    nest::port handles_test_event(nest::DataLoggingRequest &, nest::rport);
+
+
+    void get_status(DictionaryDatum &) const;
+    void set_status(const DictionaryDatum &);
+
+  private:
+    void init_state_(const Node& proto);
+    void init_buffers_();
+    void calibrate();
+
+    void update(nest::Time const &, const long, const long);
+
+    // Firing rate in Hz for the current input current
+    double compute_rate_() const;
+
+    // Update the Poisson parameters after a change in the firing rate
+    void set_rate_(double rate);
+
+    // END Boilerplate function declarations ----------------------------
+
+    // Friends --------------------------------------------------------
+    // The next two classes need to be friends to access the State_ class/member
+    friend class nest::RecordablesMap<cd_poisson_neuron>;
+    friend class nest::UniversalDataLogger<cd_poisson_neuron>;
+
+  private:
+
+    /**
+      * Store independent parameters of the model.
+      */
+    struct Parameters_{
+      double min_rate_;
+      double max_rate_;
+      double min_current_;
+      double max_current_;
+
+      //! Sample the interspike intervals instead of the counts per step
+      bool exponential_intervals_;
+
+      //! Use the counter-based generator instead of the thread generator
+      bool counter_rng_;
+
+      //! Seed of the counter-based generator
+      long rng_seed_;
+
+      Parameters_(); //!< Sets default parameter values
+
+      void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+      void set( const DictionaryDatum& ); //!< Set values from dicitonary
+    };
+
+  public:
+    // ----------------------------------------------------------------
+
+    /**
+     * State variables of the model.
+     */
+    struct State_ {
+
+      double rate_;
+
+      double input_current_;
+
+      State_(const Parameters_&);  //!< Default initialization
+      State_(const State_&);
+
+      void get(DictionaryDatum&) const;
+      void set(const DictionaryDatum&, const Parameters_&);
+    };
+
+    // ----------------------------------------------------------------
+
+  private:
+
+    /**
+     * Buffers of the model.
+     */
+    struct Buffers_ {
+      Buffers_(cd_poisson_neuron&);                   //!<Sets buffer pointers to 0
+      Buffers_(const Buffers_&, cd_poisson_neuron&);  //!<Sets buffer pointers to 0
+
+      //! Logger for all analog data
+      nest::UniversalDataLogger<cd_poisson_neuron> logger_;
+
+      /** buffers and sums up incoming currents */
+      nest::RingBuffer currents_;
+
+      double step_;           //!< step size in ms
+    };
+
+  // ------------------------------------------------------------
+
+    struct Variables_
+    {
+      PoissonSampler sampler_; //!< Spike counts for the firing rate
+    };
+
+    // Access functions for UniversalDataLogger -------------------------------
+
+    //! Read out state vector elements, used by UniversalDataLogger
+    double get_rate_() const { return S_.rate_; }
+
+    //! Read out state vector elements, used by UniversalDataLogger
+    double get_current_() const { return S_.input_current_; }
+
+  // ------------------------------------------------------------
+
+    Parameters_ P_;
+    Variables_ V_;
+    State_ S_;
+    Buffers_ B_;
+
+    //! Mapping of recordables names to access functions
+    static nest::RecordablesMap<cd_poisson_neuron> recordablesMap_;
+
+  };
+
+
+  inline
+  nest::port cd_poisson_neuron::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex, bool)
+  {
+  	nest::SpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+
+  inline
+  nest::port cd_poisson_neuron::handles_test_event(nest::CurrentEvent&, nest::rport receptor_type)
+  {
+    if (receptor_type != 0)
+      throw nest::UnknownReceptorType(receptor_type, get_name());
+    return 0;
+  }
+
+  inline
+  nest::port cd_poisson_neuron::handles_test_event(nest::DataLoggingRequest& dlr, nest::rport receptor_type)
+  {
+    if (receptor_type != 0)
+      throw nest::UnknownReceptorType(receptor_type, get_name());
+    return B_.logger_.connect_logging_device(dlr, recordablesMap_);
+  }
+
+  inline
+  void cd_poisson_neuron::get_status(DictionaryDatum &d) const
+  {
+    P_.get(d);
+    S_.get(d);
+    nest::Archiving_Node::get_status(d);
+    (*d)[nest::names::recordables] = recordablesMap_.get_list();
+  }
+
+  inline
+  void cd_poisson_neuron::set_status(const DictionaryDatum &d)
+  {
+    Parameters_ ptmp = P_;  // temporary copy in case of errors
+    ptmp.set(d);                       // throws if BadProperty
+    State_      stmp = S_;  // temporary copy in case of errors
+    stmp.set(d, ptmp);
+
+    // We now know that (ptmp, stmp) are consistent. We do not
+    // write them back to (P_, S_) before we are also sure that
+    // the properties to be set in the parent class are internally
+    // consistent.
+    nest::Archiving_Node::set_status(d);
+
+    // if we get here, temporaries contain consistent set of properties
+    P_ = ptmp;
+    S_ = stmp;
+
+  }
+
+} // namespace
+
+#endif //CD_POISSON_NEURON_H
@@ -28,9 +28,19 @@
 #include "stdp_sin_connection.h"
 #include "iaf_cond_exp_cs.h"
 #include "stdp_cos_connection.h"
+#include "stdp_sin_pair_connection.h"
+#include "stdp_cos_pair_connection.h"
+#include "stdp_cos_shared_connection.h"
+#include "stdp_sin_q16_connection.h"
+#include "stdp_cos_q16_connection.h"
+#include "stdp_cos_push_connection.h"
 #include "iaf_cond_exp_cos.h"
 #include "cd_poisson_generator.h"
+#include "cd_poisson_neuron.h"
 #include "rbf_poisson_generator.h"
+#include "rbf_encoder.h"
+#include "shm_current_generator.h"
+#include "spike_file_neuron.h"
 
 // Includes from nestkernel:
 #include "connection_manager_impl.h"
@@ -128,6 +138,21 @@ mynest::CerebellumModule::init( SLIInterpreter* i )
   nest::kernel().model_manager.register_node_model< mynest::cd_poisson_generator >(
     "cd_poisson_generator" );
 
+  nest::kernel().model_manager.register_node_model< mynest::cd_poisson_neuron >(
+    "cd_poisson_neuron" );
+
+  nest::kernel().model_manager.register_node_model< mynest::rbf_poisson_generator >(
+    "rbf_poisson_generator" );
+
+  nest::kernel().model_manager.register_node_model< mynest::rbf_encoder >(
+    "rbf_encoder" );
+
+  nest::kernel().model_manager.register_node_model< mynest::shm_current_generator >(
+    "shm_current_generator" );
+
+  nest::kernel().model_manager.register_node_model< mynest::spike_file_neuron >(
+    "spike_file_neuron" );
+
 
   /* Register a synapse type.
      Give synapse type as template argument and the name as second argument.
@@ -148,4 +173,82 @@ mynest::CerebellumModule::init( SLIInterpreter* i )
     .model_manager.register_connection_model< mynest::STDPCosConnection< nest::
         TargetIdentifierPtrRport > >( "stdp_cos_synapse" );
 
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinConnection< nest::
+        TargetIdentifierPtrRport, float > >( "stdp_sin_synapse_sp" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPCosConnection< nest::
+        TargetIdentifierPtrRport, float > >( "stdp_cos_synapse_sp" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinConnection< nest::
+        TargetIdentifierIndex > >( "stdp_sin_synapse_hpc" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPCosConnection< nest::
+        TargetIdentifierIndex > >( "stdp_cos_synapse_hpc" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinPairConnection< nest::
+        TargetIdentifierPtrRport > >( "stdp_sin_pair_synapse" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPCosPairConnection< nest::
+        TargetIdentifierPtrRport > >( "stdp_cos_pair_synapse" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPCosSharedConnection< nest::
+        TargetIdentifierPtrRport > >( "stdp_cos_shared_synapse" );
+
+  // One model per exponent, so that every synapse only stores the state
+  // variables of its exponent
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 2 > >( "stdp_sin_q16_synapse_e2" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 4 > >( "stdp_sin_q16_synapse_e4" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 6 > >( "stdp_sin_q16_synapse_e6" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 8 > >( "stdp_sin_q16_synapse_e8" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 10 > >( "stdp_sin_q16_synapse_e10" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 12 > >( "stdp_sin_q16_synapse_e12" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 14 > >( "stdp_sin_q16_synapse_e14" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 16 > >( "stdp_sin_q16_synapse_e16" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 18 > >( "stdp_sin_q16_synapse_e18" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPSinQ16Connection< nest::
+        TargetIdentifierPtrRport, 20 > >( "stdp_sin_q16_synapse_e20" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPCosQ16Connection< nest::
+        TargetIdentifierPtrRport > >( "stdp_cos_q16_synapse" );
+
+  nest::kernel()
+    .model_manager.register_connection_model< mynest::STDPCosPushConnection< nest::
+        TargetIdentifierPtrRport > >( "stdp_cos_push_synapse" );
+
 } // MyModule::init()
@@ -0,0 +1,60 @@
+/*
+ *  common_properties_check.h
+ */
+
+#ifndef COMMON_PROPERTIES_CHECK_H
+#define COMMON_PROPERTIES_CHECK_H
+
+#include "dictutils.h"
+#include "exceptions.h"
+
+#include <string>
+
+namespace mynest
+{
+
+/**
+ * Reject the learning rule parameters given in the syn_spec of Connect for a
+ * synapse model that keeps them in its common properties. keys is a list of
+ * n_keys parameter names.
+ */
+inline void
+check_no_common_properties( const DictionaryDatum& syn_spec,
+  const std::string* keys,
+  size_t n_keys,
+  const std::string& model )
+{
+  for ( size_t n = 0; n < n_keys; ++n )
+  {
+    if ( syn_spec->known( keys[ n ] ) )
+    {
+      throw nest::NotImplemented( "Connect doesn't support the setting of individual properties for "
+        + model + "; use SetDefaults or CopyModel instead." );
+    }
+  }
+}
+
+/**
+ * Reject a value of the common property key given in the status dictionary of
+ * a single connection. SetDefaults and CopyModel pass the same dictionary to
+ * the default connection after updating the common properties, so the values
+ * they set are equal to the current ones and are accepted.
+ */
+template < typename ValueT >
+inline void
+check_common_property( const DictionaryDatum& d,
+  const std::string& key,
+  ValueT value,
+  const std::string& model )
+{
+  ValueT new_value = value;
+  if ( updateValue< ValueT >( d, key, new_value ) && new_value != value )
+  {
+    throw nest::BadProperty( key + " is a common property of " + model
+      + " and can only be set with SetDefaults or CopyModel." );
+  }
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef COMMON_PROPERTIES_CHECK_H
@@ -0,0 +1,151 @@
+/*
+ *  counter_rng.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file counter_rng.h
+ * Counter-based random numbers (Philox4x32-10, Salmon et al. 2011). Every
+ * block of four numbers is a pure function of a key and a counter, so the
+ * random numbers of a node do not depend on the thread or process that
+ * updates it, nor on the order in which the nodes are updated.
+ */
+
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cmath>
+#include <stdint.h>
+
+namespace mynest
+{
+
+class CounterRNG
+{
+public:
+  /**
+   * Purposes of the draws, used as part of the counter so that the streams
+   * of different uses never overlap.
+   */
+  enum Streams
+  {
+    STEP_STREAM = 0,    //!< One draw per time step
+    INTERVAL_STREAM,    //!< Sequential draws of interspike intervals
+    TARGET_STREAM,      //!< One draw per time step and target
+    ROUNDING_STREAM     //!< One draw per presynaptic spike of a synapse
+  };
+
+  CounterRNG()
+  {
+    key_[ 0 ] = key_[ 1 ] = 0;
+  }
+
+  /**
+   * Set the key from the id of the node and a seed.
+   */
+  void set_key( uint64_t gid, uint32_t seed )
+  {
+    // Node ids fit in 32 bits in practice, the high bits are mixed into the
+    // seed word to keep the keys unique otherwise
+    key_[ 0 ] = static_cast< uint32_t >( gid );
+    key_[ 1 ] = seed ^ static_cast< uint32_t >( gid >> 32 );
+  }
+
+  /**
+   * Four uniform numbers in (0, 1) for the counter (index, stream, sub).
+   */
+  void uniforms( uint64_t index, uint32_t stream, uint32_t sub, double u[ 4 ] ) const
+  {
+    uint32_t ctr[ 4 ] = { static_cast< uint32_t >( index ), static_cast< uint32_t >( index >> 32 ), stream, sub };
+    uint32_t out[ 4 ];
+    philox4x32_10_( ctr, out );
+    for ( int i = 0; i < 4; ++i )
+    {
+      u[ i ] = ( out[ i ] + 0.5 ) * ( 1.0 / 4294967296.0 );
+    }
+  }
+
+  /**
+   * Poisson number with mean lambda from the uniform number u, by inversion.
+   * exp_minus_lambda must be exp(-lambda). The cost grows with lambda, which
+   * is well below 1 for the firing rates and time steps of these models.
+   */
+  static long poisson( double u, double lambda, double exp_minus_lambda )
+  {
+    long k = 0;
+    double p = exp_minus_lambda;
+    double cdf = p;
+    while ( u > cdf && p > 0.0 )
+    {
+      ++k;
+      p *= lambda / k;
+      cdf += p;
+    }
+    return k;
+  }
+
+  /**
+   * Exponential number with mean 1 from the uniform number u.
+   */
+  static double exponential( double u )
+  {
+    return -std::log( u );
+  }
+
+private:
+  uint32_t key_[ 2 ];
+
+  static void mulhilo_( uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo )
+  {
+    const uint64_t product = static_cast< uint64_t >( a ) * b;
+    hi = static_cast< uint32_t >( product >> 32 );
+    lo = static_cast< uint32_t >( product );
+  }
+
+  void philox4x32_10_( const uint32_t in[ 4 ], uint32_t out[ 4 ] ) const
+  {
+    uint32_t c0 = in[ 0 ], c1 = in[ 1 ], c2 = in[ 2 ], c3 = in[ 3 ];
+    uint32_t k0 = key_[ 0 ], k1 = key_[ 1 ];
+
+    for ( int round = 0; round < 10; ++round )
+    {
+      uint32_t hi0, lo0, hi1, lo1;
+      mulhilo_( 0xD2511F53u, c0, hi0, lo0 );
+      mulhilo_( 0xCD9E8D57u, c2, hi1, lo1 );
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+
+      // Weyl sequence of the key
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+
+    out[ 0 ] = c0;
+    out[ 1 ] = c1;
+    out[ 2 ] = c2;
+    out[ 3 ] = c3;
+  }
+};
+
+} // of namespace mynest
+
+#endif // of #ifndef COUNTER_RNG_H
@@ -32,11 +32,19 @@
 
 // member functions of histentry
 
-mynest::histentry_cos::histentry_cos( double t, double cos2, double sin2, double cossin, size_t access_counter )
-  : t_( t )
+mynest::histentry_cos::histentry_cos( unsigned int t_steps, float offset, unsigned int multiplicity, unsigned int access_counter )
+  : t_steps_( t_steps )
+  , offset_( offset )
+  , multiplicity_( multiplicity )
+  , access_counter_( access_counter )
+{
+}
+
+mynest::histcheckpoint_cos::histcheckpoint_cos( unsigned int t_steps, float offset, double cos2, double sin2, double cossin )
+  : t_steps_( t_steps )
+  , offset_( offset )
   , cos2_( cos2 )
   , sin2_( sin2 )
   , cossin_( cossin )
-  , access_counter_( access_counter )
 {
 }
@@ -41,19 +41,34 @@ namespace mynest
 class histentry_cos
 {
 public:
-  histentry_cos( double t, double cos2, double sin2, double cossin, size_t access_counter );
+  histentry_cos( unsigned int t_steps, float offset, unsigned int multiplicity, unsigned int access_counter );
 
-  double t_;              //!< point in time when spike occurred (in ms)
+  unsigned int t_steps_;  //!< point in time when spike occurred (in steps, relative to the base step of the archiver)
+
+  float offset_;          //!< time of the spike before the end of that step (in ms)
+
+  unsigned int multiplicity_;  //!< number of spikes which occurred at that time
+
+  //! how often this entry was accessed (to enable removal, once read by all
+  //! neurons which need it)
+  unsigned int access_counter_;
+};
+
+// state of the trace right after a spike in the history
+class histcheckpoint_cos
+{
+public:
+  histcheckpoint_cos( unsigned int t_steps, float offset, double cos2, double sin2, double cossin );
+
+  unsigned int t_steps_;  //!< point in time when spike occurred (in steps, relative to the base step of the archiver)
+
+  float offset_;          //!< time of the spike before the end of that step (in ms)
 
   double cos2_;
 
   double sin2_;
 
   double cossin_;
-
-  //! how often this entry was accessed (to enable removal, once read by all
-  //! neurons which need it)
-  size_t access_counter_;
 };
 }
 
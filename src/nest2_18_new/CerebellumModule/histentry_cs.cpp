@@ -32,8 +32,10 @@
 
 // member functions of histentry
 
-mynest::histentry_cs::histentry_cs( double t, size_t access_counter )
-  : t_( t )
+mynest::histentry_cs::histentry_cs( unsigned int t_steps, float offset, unsigned int multiplicity, unsigned int access_counter )
+  : t_steps_( t_steps )
+  , offset_( offset )
+  , multiplicity_( multiplicity )
   , access_counter_( access_counter )
 {
 }
@@ -41,12 +41,14 @@ namespace mynest
 class histentry_cs
 {
 public:
-  histentry_cs( double t, size_t access_counter );
+  histentry_cs( unsigned int t_steps, float offset, unsigned int multiplicity, unsigned int access_counter );
 
-  double t_;              //!< point in time when spike occurred (in ms)
+  unsigned int t_steps_;  //!< point in time when spike occurred (in steps, relative to the base step of the archiver)
+  float offset_;          //!< time of the spike before the end of that step (in ms)
+  unsigned int multiplicity_;  //!< number of spikes which occurred at that time
   //! how often this entry was accessed (to enable removal, once read by all
   //! neurons which need it)
-  size_t access_counter_;
+  unsigned int access_counter_;
 };
 }
 
@@ -20,6 +20,7 @@
 #include "connection.h"
 #include "universal_data_logger.h"
 #include "recordables_map.h"
+#include "rk_integrator.h"
 
 #include <gsl/gsl_errno.h>
 #include <gsl/gsl_matrix.h>
@@ -53,15 +54,35 @@ C_m        double - Capacity of the membrane in pF
 g_L        double - Leak conductance in nS;
 tau_cos	   double - Time constant of the cosine learning rule in ms.
 exponent   double - Exponent of the cosine learning rule.
+checkpoint_interval int - Number of teaching spikes between consecutive
+           snapshots of the learning trace kept in the spike history.
+           The trace after any other spike is recomputed when needed.
 tau_syn_ex double - Time constant of the excitatory synaptic exponential function in ms.
 tau_syn_in double - Time constant of the inhibitory synaptic exponential function in ms.
 tau_syn_cs double - Time constant of the complex spike synaptic exponential function in ms.
 I_e        double - Constant external input current in pA.
+precise_times bool - Emit spikes at the threshold crossing time, linearly
+           interpolated within the step, instead of at the end of the step.
+integrator string - ODE solver: "gsl" (GSL RKF45, default), "rkf45" (inlined
+           RKF45 with the same step size control as "gsl") or "rk4" (inlined
+           classical Runge-Kutta with one step per simulation step).
 
 Sends: SpikeEvent
 
 Receives: SpikeEvent, CurrentEvent, DataLoggingRequest
 
+Remarks:
+The spike receptors are AMPA (1), GABA (2) and TEACHING_SIGNAL (3); receptor 0 is
+rejected. The AMPA connections are stored with port 0, the only port of the
+*_hpc plastic synapses, so these synapses reach the excitatory input when
+they are connected with receptor_type AMPA.
+
+With precise_times, the offsets of the teaching signal spikes are stored in the
+spike history as well, so that the plastic synapses see their exact times.
+The synaptic conductances still change at the end of the step. Set
+precise_times with SetDefaults before creating the neurons, or set the
+off_grid_spiking kernel property, so that NEST transmits the offsets.
+
 References: 
 
 Author: Jesus Garrido
@@ -78,6 +99,7 @@ namespace nest
     	extern const Name tau_syn_ts;  //!<  Time constant of the complex spike synaptic exponential function in ms.
     	extern const Name E_ts;        //!<  Complex spike reversal potential in mV.
       extern const Name g_ts;
+      extern const Name integrator;
       extern const Name TEACHING_SIGNAL;
       extern const Name GABA_R;
     }
@@ -131,6 +153,11 @@ namespace mynest
     
     void get_status(DictionaryDatum &) const;
     void set_status(const DictionaryDatum &);
+
+    bool is_off_grid() const
+    {
+      return P_.precise_times_;
+    }
     
   private:
     void init_state_(const Node& proto);
@@ -161,6 +188,18 @@ namespace mynest
     SUP_SPIKE_RECEPTOR
   };
 
+    //! Port of the AMPA connections. The _hpc synapses can only store port 0,
+    //! so the AMPA receptor is received through it.
+    static const nest::rport AMPA_PORT = 0;
+
+    // ODE solvers
+    enum Integrators
+  {
+    GSL_RKF45 = 0,
+    INLINED_RKF45,
+    INLINED_RK4
+  };
+
     //! Model parameters
 	struct Parameters_ {
 	  double V_reset_;    //!< Reset Potential in mV
@@ -176,6 +215,8 @@ namespace mynest
 	  double tau_synI;    //!< Synaptic Time Constant for Inhibitory Synapse in ms
     double tau_synTS;   //!< Synaptic Time Constant for TS Synapse in ms
 	  double I_e;         //!< Constant Current in pA
+	  bool precise_times_; //!< Emit spikes at the interpolated threshold crossing
+	  Integrators integrator_; //!< ODE solver
 	  
 	  Parameters_();  //!< Sets default parameter values
 
@@ -213,6 +254,22 @@ namespace mynest
 
     // ---------------------------------------------------------------- 
 
+  private:
+    /**
+     * Right-hand side of the ODE as a functor, so that the inlined solvers
+     * can inline it. The GSL solver calls it through iaf_cond_exp_cos_dynamics.
+     */
+    struct Dynamics_ {
+      Dynamics_(const Parameters_& p, double I_stim) : P_(p), I_stim_(I_stim) {}
+
+      void operator()(const double y[], double f[]) const;
+
+      const Parameters_& P_;
+      const double I_stim_;
+    };
+
+    // ---------------------------------------------------------------- 
+
   private:
     /**
      * Buffers of the model.
@@ -235,6 +292,9 @@ namespace mynest
       gsl_odeiv_control* c_;    //!< adaptive stepsize control function
       gsl_odeiv_evolve*  e_;    //!< evolution function
       gsl_odeiv_system   sys_;  //!< struct describing system
+
+      //! Inlined adaptive solver, used instead of GSL if selected
+      RKF45Integrator<State_::STATE_VEC_SIZE> rkf45_;
       
       // IntergrationStep_ should be reset with the neuron on ResetNetwork,
       // but remain unchanged during calibration. Since it is initialized with
@@ -260,6 +320,12 @@ namespace mynest
       */
      struct Variables_ { 
     	int    RefractoryCounts_;
+
+    	// Decay of the conductances over one step, used to propagate them
+    	// during the refractory period without the ODE solver
+    	double P_exc_;
+    	double P_inh_;
+    	double P_ts_;
      };
 
     // Access functions for UniversalDataLogger -------------------------------
@@ -294,7 +360,7 @@ namespace mynest
     if (not( INF_SPIKE_RECEPTOR < receptor_type
          && receptor_type < SUP_SPIKE_RECEPTOR ))
       throw nest::UnknownReceptorType(receptor_type, get_name());
-    return receptor_type;
+    return receptor_type == AMPA ? AMPA_PORT : receptor_type;
   }
  
   inline
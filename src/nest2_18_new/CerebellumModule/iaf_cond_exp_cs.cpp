@@ -18,6 +18,7 @@
 #include "dictutils.h"
 #include "numerics.h"
 #include <limits>
+#include <cmath>
 
 #include "universal_data_logger_impl.h"
 #include "event.h"
@@ -59,35 +60,41 @@ namespace nest  // template specialization must be placed in namespace
       const Name g_cs("g_cs");
       const Name GABA("GABA");
       const Name COMPLEX_SPIKE("COMPLEX_SPIKE");
+      const Name integrator("integrator");
   }
 }
 
-extern "C"
-inline int mynest::iaf_cond_exp_cs_dynamics(double, const double y[], double f[], void* pnode)
+inline void mynest::iaf_cond_exp_cs::Dynamics_::operator()(const double y[], double f[]) const
 { 
   // a shorthand
   typedef mynest::iaf_cond_exp_cs::State_ S;
 
-  // get access to node so we can almost work as in a member function
-  assert(pnode);
-  const mynest::iaf_cond_exp_cs& node =  *(reinterpret_cast<mynest::iaf_cond_exp_cs*>(pnode));
-
   // y[] here is---and must be---the state vector supplied by the integrator,
   // not the state vector in the node, node.S_.y[]. 
 
   // The following code is verbose for the sake of clarity. We assume that a
   // good compiler will optimize the verbosity away ...
-  const double I_syn_exc = y[S::G_EXC] * (y[S::V_M] - node.P_.E_ex); 
-  const double I_syn_inh = y[S::G_INH] * (y[S::V_M] - node.P_.E_in); 
-  const double I_syn_cs = y[S::G_CS] * (y[S::V_M] - node.P_.E_cs); 
-  const double I_L       = node.P_.g_L * ( y[S::V_M] - node.P_.E_L );
-  const double I_total   = node.P_.I_e - I_syn_exc - I_syn_inh - I_syn_cs;
+  const double I_syn_exc = y[S::G_EXC] * (y[S::V_M] - P_.E_ex); 
+  const double I_syn_inh = y[S::G_INH] * (y[S::V_M] - P_.E_in); 
+  const double I_syn_cs = y[S::G_CS] * (y[S::V_M] - P_.E_cs); 
+  const double I_L       = P_.g_L * ( y[S::V_M] - P_.E_L );
+  const double I_total   = P_.I_e - I_syn_exc - I_syn_inh - I_syn_cs;
   
   //V dot
-  f[0] = ( - I_L + node.B_.I_stim_ + I_total) / node.P_.C_m; // Vm diff. equation
-  f[1] = -y[S::G_EXC] / node.P_.tau_synE; // Gexc diff. equation
-  f[2] = -y[S::G_INH] / node.P_.tau_synI; // Ginh diff. equation
-  f[3] = -y[S::G_CS] / node.P_.tau_synCS; // Gcs diff. equation
+  f[0] = ( - I_L + I_stim_ + I_total) / P_.C_m; // Vm diff. equation
+  f[1] = -y[S::G_EXC] / P_.tau_synE; // Gexc diff. equation
+  f[2] = -y[S::G_INH] / P_.tau_synI; // Ginh diff. equation
+  f[3] = -y[S::G_CS] / P_.tau_synCS; // Gcs diff. equation
+}
+
+extern "C"
+inline int mynest::iaf_cond_exp_cs_dynamics(double, const double y[], double f[], void* pnode)
+{ 
+  // get access to node so we can almost work as in a member function
+  assert(pnode);
+  const mynest::iaf_cond_exp_cs& node =  *(reinterpret_cast<mynest::iaf_cond_exp_cs*>(pnode));
+
+  iaf_cond_exp_cs::Dynamics_(node.P_, node.B_.I_stim_)(y, f);
 
   return GSL_SUCCESS;
 }
@@ -109,7 +116,9 @@ mynest::iaf_cond_exp_cs::Parameters_::Parameters_()
 	tau_synE   (  0.2    ),  // ms
   tau_synI   (  2.0    ),  // ms
   tau_synCS   (  5.0    ),  // ms
-  I_e        (  0.0    )  // pA
+  I_e        (  0.0    ),  // pA
+  precise_times_( false ),
+  integrator_( GSL_RKF45 )
 {
 }
 
@@ -156,6 +165,19 @@ void mynest::iaf_cond_exp_cs::Parameters_::get(DictionaryDatum &d) const
 	def<double>(d,nest::names::tau_syn_in,   tau_synI);
   def<double>(d,nest::names::tau_syn_cs,   tau_synCS);
 	def<double>(d,nest::names::I_e,          I_e);
+	def<bool>(d,nest::names::precise_times, precise_times_);
+
+	switch ( integrator_ )
+	{
+	case INLINED_RKF45:
+	  def<std::string>(d,nest::names::integrator, "rkf45");
+	  break;
+	case INLINED_RK4:
+	  def<std::string>(d,nest::names::integrator, "rk4");
+	  break;
+	default:
+	  def<std::string>(d,nest::names::integrator, "gsl");
+	}
 }
 
 void mynest::iaf_cond_exp_cs::Parameters_::set(const DictionaryDatum& d)
@@ -178,6 +200,20 @@ void mynest::iaf_cond_exp_cs::Parameters_::set(const DictionaryDatum& d)
     updateValue<double>(d,nest::names::tau_syn_cs, tau_synCS);
 
 	  updateValue<double>(d,nest::names::I_e,     I_e);
+	  updateValue<bool>(d,nest::names::precise_times, precise_times_);
+
+	  std::string integrator;
+	  if ( updateValue<std::string>(d,nest::names::integrator, integrator) )
+	  {
+	    if ( integrator == "gsl" )
+	      integrator_ = GSL_RKF45;
+	    else if ( integrator == "rkf45" )
+	      integrator_ = INLINED_RKF45;
+	    else if ( integrator == "rk4" )
+	      integrator_ = INLINED_RK4;
+	    else
+	      throw nest::BadProperty("integrator must be \"gsl\", \"rkf45\" or \"rk4\".");
+	  }
 
 	// if ( V_reset_ >= V_th_ )
 	//     throw nest::BadProperty("Reset potential must be smaller than threshold.");
@@ -311,6 +347,11 @@ void mynest::iaf_cond_exp_cs::calibrate()
 
   V_.RefractoryCounts_ = nest::Time(nest::Time::ms(P_.t_ref_)).get_steps();
   assert(V_.RefractoryCounts_ >= 0);  // since t_ref_ >= 0, this can only fail in error
+
+  const double h = nest::Time::get_resolution().get_ms();
+  V_.P_exc_ = std::exp(-h / P_.tau_synE);
+  V_.P_inh_ = std::exp(-h / P_.tau_synI);
+  V_.P_cs_ = std::exp(-h / P_.tau_synCS);
 }
 
 /* ---------------------------------------------------------------- 
@@ -326,31 +367,53 @@ void mynest::iaf_cond_exp_cs::update(nest::Time const & origin, const long from,
   for ( long lag = from ; lag < to ; ++lag )
   {
     
-    double t = 0.0;
-
-    // numerical integration with adaptive step size control:
-    // ------------------------------------------------------
-    // gsl_odeiv_evolve_apply performs only a single numerical
-    // integration step, starting from t and bounded by step;
-    // the while-loop ensures integration over the whole simulation
-    // step (0, step] if more than one integration step is needed due
-    // to a small integration step size;
-    // note that (t+IntegrationStep > step) leads to integration over
-    // (t, step] and afterwards setting t to step, but it does not
-    // enforce setting IntegrationStep to step-t; this is of advantage
-    // for a consistent and efficient integration across subsequent
-    // simulation intervals
-    while ( t < B_.step_ )
-        {
-          const int status = gsl_odeiv_evolve_apply(B_.e_, B_.c_, B_.s_,
-    			   &B_.sys_,             // system of ODE
-    			   &t,                   // from t
-    			    B_.step_,            // to t <= step
-    			   &B_.IntegrationStep_, // integration step size
-    			    S_.y_); 	         // neuronal state
-          if ( status != GSL_SUCCESS )
-            throw nest::GSLSolverFailure(get_name(), status);
-        }
+    const double V_old = S_.y_[State_::V_M];
+
+    if ( S_.r_ )
+    {
+      // V_m is clamped to V_reset at the end of every refractory step, so
+      // only the conductances need to be propagated. They decay exactly
+      // exponentially, independently of V_m.
+      S_.y_[State_::G_EXC] *= V_.P_exc_;
+      S_.y_[State_::G_INH] *= V_.P_inh_;
+      S_.y_[State_::G_CS] *= V_.P_cs_;
+    }
+    else if ( P_.integrator_ == INLINED_RKF45 )
+    {
+      B_.rkf45_.evolve(Dynamics_(P_, B_.I_stim_), B_.step_, B_.IntegrationStep_, S_.y_);
+    }
+    else if ( P_.integrator_ == INLINED_RK4 )
+    {
+      RK4Integrator<State_::STATE_VEC_SIZE>::step(Dynamics_(P_, B_.I_stim_), B_.step_, S_.y_);
+    }
+    else
+    {
+      double t = 0.0;
+
+      // numerical integration with adaptive step size control:
+      // ------------------------------------------------------
+      // gsl_odeiv_evolve_apply performs only a single numerical
+      // integration step, starting from t and bounded by step;
+      // the while-loop ensures integration over the whole simulation
+      // step (0, step] if more than one integration step is needed due
+      // to a small integration step size;
+      // note that (t+IntegrationStep > step) leads to integration over
+      // (t, step] and afterwards setting t to step, but it does not
+      // enforce setting IntegrationStep to step-t; this is of advantage
+      // for a consistent and efficient integration across subsequent
+      // simulation intervals
+      while ( t < B_.step_ )
+          {
+            const int status = gsl_odeiv_evolve_apply(B_.e_, B_.c_, B_.s_,
+      			   &B_.sys_,             // system of ODE
+      			   &t,                   // from t
+      			    B_.step_,            // to t <= step
+      			   &B_.IntegrationStep_, // integration step size
+      			    S_.y_); 	         // neuronal state
+            if ( status != GSL_SUCCESS )
+              throw nest::GSLSolverFailure(get_name(), status);
+          }
+    }
 
         S_.y_[State_::G_EXC] += B_.spike_exc_.get_value(lag);
         S_.y_[State_::G_INH] += B_.spike_inh_.get_value(lag);
@@ -366,12 +429,19 @@ void mynest::iaf_cond_exp_cs::update(nest::Time const & origin, const long from,
           // neuron is not absolute refractory
           if ( S_.y_[State_::V_M] >=  P_.V_th_)
     	    {
+            // Time of the threshold crossing before the end of the step, by
+            // linear interpolation of the membrane potential
+            double offset = 0.0;
+            if ( P_.precise_times_ && V_old < P_.V_th_ )
+              offset = B_.step_ * ( S_.y_[State_::V_M] - P_.V_th_ ) / ( S_.y_[State_::V_M] - V_old );
+
     	      S_.r_              = V_.RefractoryCounts_;
     	      S_.y_[State_::V_M] = P_.V_reset_;
 
-            set_spiketime(nest::Time::step(origin.get_steps()+lag+1));
+            set_spiketime(nest::Time::step(origin.get_steps()+lag+1), offset);
 
     	      nest::SpikeEvent se;
+    	      se.set_offset(offset);
     	      nest::kernel().event_delivery_manager.send(*this, se, lag);
     	    }
     
@@ -388,16 +458,16 @@ void mynest::iaf_cond_exp_cs::handle(nest::SpikeEvent & e)
 {
   assert(e.get_delay_steps() > 0);
 
-  assert(( e.get_rport() > INF_SPIKE_RECEPTOR ) && ( ( size_t ) e.get_rport() <= SUP_SPIKE_RECEPTOR ) );
+  assert(( e.get_rport() >= INF_SPIKE_RECEPTOR ) && ( ( size_t ) e.get_rport() <= SUP_SPIKE_RECEPTOR ) );
 
   const long spike_time = e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin());
 
   switch(e.get_rport()){
     case COMPLEX_SPIKE:
       B_.spike_cs_.add_value(spike_time, e.get_weight() * e.get_multiplicity() );
-      set_cs_spiketime(nest::Time::step(nest::kernel().simulation_manager.get_slice_origin().get_steps()+e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin())));
+      set_cs_spiketime(nest::Time::step(nest::kernel().simulation_manager.get_slice_origin().get_steps()+e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin())), e.get_multiplicity(), e.get_offset());
       break;
-    case AMPA:
+    case AMPA_PORT:
       B_.spike_exc_.add_value(e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin()),
           e.get_weight() * e.get_multiplicity() );
       break;
@@ -0,0 +1,154 @@
+/*
+ *  mapped_file.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mapped_file.h"
+
+// Includes from nestkernel:
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::map< std::string, std::weak_ptr< const mynest::MappedFile > > mynest::MappedFile::shared_files_;
+
+mynest::MappedFile::MappedFile()
+  : data_( 0 )
+  , size_( 0 )
+{
+}
+
+mynest::MappedFile::~MappedFile()
+{
+  close();
+}
+
+void
+mynest::MappedFile::open( const std::string& path )
+{
+  close();
+
+  const int fd = ::open( path.c_str(), O_RDONLY );
+  if ( fd < 0 )
+  {
+    throw nest::KernelException( ( "Cannot open " + path + ": " + std::strerror( errno ) ).c_str() );
+  }
+
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || st.st_size == 0 )
+  {
+    ::close( fd );
+    throw nest::KernelException( ( "Cannot map " + path + ": the file is empty or cannot be read." ).c_str() );
+  }
+
+  void* addr = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+
+  // The mapping keeps a reference to the file
+  ::close( fd );
+
+  if ( addr == MAP_FAILED )
+  {
+    throw nest::KernelException( ( "Cannot map " + path + ": " + std::strerror( errno ) ).c_str() );
+  }
+
+  data_ = static_cast< const char* >( addr );
+  size_ = st.st_size;
+  path_ = path;
+}
+
+void
+mynest::MappedFile::close()
+{
+  if ( data_ != 0 )
+  {
+    munmap( const_cast< char* >( data_ ), size_ );
+    data_ = 0;
+    size_ = 0;
+  }
+  path_.clear();
+}
+
+void
+mynest::MappedFile::advise_sequential() const
+{
+  if ( data_ != 0 )
+  {
+    madvise( const_cast< char* >( data_ ), size_, MADV_SEQUENTIAL );
+  }
+}
+
+void
+mynest::MappedFile::release( size_t offset, size_t length ) const
+{
+  // madvise works on whole pages, so only the pages that lie entirely in
+  // the range are released
+  const size_t page = sysconf( _SC_PAGESIZE );
+  const size_t begin = ( offset + page - 1 ) / page * page;
+  const size_t end = std::min( offset + length, size_ ) / page * page;
+
+  if ( data_ != 0 && begin < end )
+  {
+    madvise( const_cast< char* >( data_ + begin ), end - begin, MADV_DONTNEED );
+  }
+}
+
+std::shared_ptr< const mynest::MappedFile >
+mynest::MappedFile::shared( const std::string& path )
+{
+  std::shared_ptr< const MappedFile > file;
+  std::string error;
+
+  // The nodes are calibrated in parallel by all the threads, and exceptions
+  // cannot leave the critical section
+#pragma omp critical( mapped_file )
+  {
+    file = shared_files_[ path ].lock();
+    if ( !file )
+    {
+      try
+      {
+        std::shared_ptr< MappedFile > new_file( new MappedFile() );
+        new_file->open( path );
+        new_file->advise_sequential();
+        shared_files_[ path ] = new_file;
+        file = new_file;
+      }
+      catch ( nest::KernelException& e )
+      {
+        shared_files_.erase( path );
+        error = e.what();
+      }
+    }
+  }
+
+  if ( !file )
+  {
+    throw nest::KernelException( error.c_str() );
+  }
+
+  return file;
+}
@@ -0,0 +1,115 @@
+/*
+ *  mapped_file.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file mapped_file.h
+ * Read-only memory mapping of a file, used by the devices that take their
+ * input from files or shared memory written by other processes.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace mynest
+{
+
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  /**
+   * Map the whole file at path, closing the previous mapping.
+   * Throws nest::KernelException if the file cannot be opened or mapped.
+   */
+  void open( const std::string& path );
+
+  /**
+   * Remove the mapping. Does nothing if no file is mapped.
+   */
+  void close();
+
+  /**
+   * Tell the kernel that the mapping will be read sequentially, so that the
+   * pages ahead are read in advance.
+   */
+  void advise_sequential() const;
+
+  /**
+   * Release the pages in [offset, offset + length), which have already been
+   * read. They are read again from the file if they are accessed later.
+   */
+  void release( size_t offset, size_t length ) const;
+
+  /**
+   * Mapping of the file at path shared by all the nodes that read it, so
+   * that a large population maps the file only once. The mapping is removed
+   * when the last node releases it.
+   */
+  static std::shared_ptr< const MappedFile > shared( const std::string& path );
+
+  bool
+  is_open() const
+  {
+    return data_ != 0;
+  }
+
+  const char*
+  data() const
+  {
+    return data_;
+  }
+
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  const std::string&
+  path() const
+  {
+    return path_;
+  }
+
+private:
+  // The mapping is owned by a single object
+  MappedFile( const MappedFile& );
+  MappedFile& operator=( const MappedFile& );
+
+  const char* data_;
+  size_t size_;
+  std::string path_;
+
+  //! Shared mappings by path
+  static std::map< std::string, std::weak_ptr< const MappedFile > > shared_files_;
+};
+
+} // of namespace mynest
+
+#endif // of #ifndef MAPPED_FILE_H
@@ -0,0 +1,259 @@
+/*
+ *  poisson_sampler.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file poisson_sampler.h
+ * Spike counts of the current-driven Poisson models (cd_poisson_generator
+ * and cd_poisson_neuron): mapping of the input current to the firing rate,
+ * and sampling of the spikes of every step, either as a Poisson count or
+ * from exponential interspike intervals, with the random generator of the
+ * thread or with the counter-based generator.
+ */
+
+#ifndef POISSON_SAMPLER_H
+#define POISSON_SAMPLER_H
+
+// Includes from librandom:
+#include "exp_randomdev.h"
+#include "poisson_randomdev.h"
+
+#include "counter_rng.h"
+
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+
+namespace mynest
+{
+
+class PoissonSampler
+{
+public:
+  PoissonSampler()
+    : use_counter_rng_( false )
+    , lambda_( 0.0 )
+    , exp_minus_lambda_( 1.0 )
+    , budget_( -1.0 )
+    , step_block_( -1 )
+    , n_intervals_( 0 )
+  {
+  }
+
+  /**
+   * Firing rate in Hz for the input current. The rate grows linearly from
+   * min_rate at min_current to max_rate at max_current, and is constant
+   * outside that range.
+   */
+  static double current_to_rate( double current,
+    double min_current,
+    double max_current,
+    double min_rate,
+    double max_rate )
+  {
+    if ( current <= min_current )
+    {
+      return min_rate;
+    }
+    else if ( current >= max_current )
+    {
+      return max_rate;
+    }
+
+    return ( current - min_current ) / ( max_current - min_current ) * ( max_rate - min_rate ) + min_rate;
+  }
+
+  /**
+   * Discard the drawn random numbers and the pending spike.
+   */
+  void reset()
+  {
+    budget_ = -1.0;
+    step_block_ = -1;
+    n_intervals_ = 0;
+    target_blocks_.clear();
+  }
+
+  /**
+   * Draw from the counter-based generator keyed by the node id and the seed
+   * instead of the random generator of the thread.
+   */
+  void set_counter_rng( bool use_counter_rng, uint64_t gid, uint32_t seed )
+  {
+    use_counter_rng_ = use_counter_rng;
+    crng_.set_key( gid, seed );
+  }
+
+  /**
+   * Update the Poisson parameters after a change in the firing rate (in Hz)
+   * with time steps of step ms.
+   */
+  void set_rate( double rate, double step )
+  {
+    // rate is in Hz, step in ms, so we have to convert from s to ms
+    lambda_ = step * rate * 1e-3;
+    exp_minus_lambda_ = std::exp( -lambda_ );
+    poisson_dev_.set_lambda( lambda_ );
+  }
+
+  /**
+   * Number of spikes in the step (step, step+1], drawn as a Poisson count.
+   */
+  long poisson_spikes( long step, librandom::RngPtr rng )
+  {
+    return use_counter_rng_ ? counter_poisson_( step ) : poisson_dev_.ldev( rng );
+  }
+
+  /**
+   * Number of spikes in the next step, counted from the exponential
+   * interspike intervals by time rescaling: every interval is a budget of
+   * expected spikes drawn from an exponential distribution of mean 1, which
+   * every step spends by its expected number of spikes. Random numbers are
+   * only drawn when a spike is emitted, also when the rate changes.
+   */
+  long interval_spikes( librandom::RngPtr rng )
+  {
+    if ( budget_ < 0.0 )
+    {
+      budget_ = next_interval_( rng );
+    }
+
+    budget_ -= lambda_;
+
+    long n_spikes = 0;
+    while ( budget_ <= 0.0 )
+    {
+      ++n_spikes;
+      budget_ += next_interval_( rng );
+    }
+    return n_spikes;
+  }
+
+  /**
+   * Number of spikes of the target with id target in the step, drawn as a
+   * Poisson count independent of the other targets. slot is a small index
+   * of the target (e.g. its port), under which its block of uniform numbers
+   * is cached; any slot gives the same counts.
+   */
+  long target_spikes( long step, uint32_t target, size_t slot, librandom::RngPtr rng )
+  {
+    if ( !use_counter_rng_ )
+    {
+      return poisson_dev_.ldev( rng );
+    }
+
+    if ( slot >= target_blocks_.size() )
+    {
+      target_blocks_.resize( slot + 1 );
+    }
+
+    // The train of every target is keyed by its id, which does not depend
+    // on the thread that delivers the event. Four consecutive steps share
+    // one block of the generator, as in counter_poisson_
+    TargetBlock& cached = target_blocks_[ slot ];
+    const long block = step / 4;
+    if ( cached.block_ != block || cached.target_ != target )
+    {
+      crng_.uniforms( block, CounterRNG::TARGET_STREAM, target, cached.u_ );
+      cached.block_ = block;
+      cached.target_ = target;
+    }
+
+    return CounterRNG::poisson( cached.u_[ step % 4 ], lambda_, exp_minus_lambda_ );
+  }
+
+private:
+  // Draw the spike count of one step from the counter-based generator
+  long counter_poisson_( long step )
+  {
+    // Four consecutive steps share one block of the generator
+    const long block = step / 4;
+    if ( block != step_block_ )
+    {
+      crng_.uniforms( block, CounterRNG::STEP_STREAM, 0, step_u_ );
+      step_block_ = block;
+    }
+
+    return CounterRNG::poisson( step_u_[ step % 4 ], lambda_, exp_minus_lambda_ );
+  }
+
+  // Draw the next interspike interval, in units of the mean interval
+  double next_interval_( librandom::RngPtr rng )
+  {
+    if ( !use_counter_rng_ )
+    {
+      return exp_dev_( rng );
+    }
+
+    const unsigned long lane = n_intervals_ % 4;
+    if ( lane == 0 )
+    {
+      crng_.uniforms( n_intervals_ / 4, CounterRNG::INTERVAL_STREAM, 0, interval_u_ );
+    }
+    ++n_intervals_;
+
+    return CounterRNG::exponential( interval_u_[ lane ] );
+  }
+
+  librandom::PoissonRandomDev poisson_dev_; //!< Random deviate generator
+  librandom::ExpRandomDev exp_dev_;         //!< Interspike interval generator
+
+  bool use_counter_rng_;
+  CounterRNG crng_; //!< Counter-based generator keyed by the node id
+
+  double lambda_;           //!< Expected number of spikes per step
+  double exp_minus_lambda_; //!< exp(-lambda_)
+
+  //! Expected number of spikes left until the next spike in exponential
+  //! intervals mode, or -1 if it has to be drawn
+  double budget_;
+
+  //! Block of uniform numbers of the counter-based generator for four
+  //! consecutive steps, and index of that block (-1 if none)
+  double step_u_[ 4 ];
+  long step_block_;
+
+  //! Block of uniform numbers for the interspike intervals, and number of
+  //! intervals drawn so far
+  double interval_u_[ 4 ];
+  unsigned long n_intervals_;
+
+  //! Block of uniform numbers of a target for four consecutive steps
+  struct TargetBlock
+  {
+    TargetBlock()
+      : block_( -1 )
+      , target_( 0 )
+    {
+    }
+
+    long block_;
+    uint32_t target_;
+    double u_[ 4 ];
+  };
+
+  //! Cached blocks of the targets, indexed by their slots
+  std::vector< TargetBlock > target_blocks_;
+};
+
+} // of namespace mynest
+
+#endif // of #ifndef POISSON_SAMPLER_H
@@ -0,0 +1,411 @@
+/*
+ *  rbf_encoder.cpp
+ *
+ *  This file is based on the poisson generator model distributed with NEST.
+ */
+
+#include "rbf_encoder.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+#include "ExponentialTable.h"
+
+#include <algorithm>
+
+
+namespace nest
+{
+  namespace names
+  {
+      const Name num_inputs("num_inputs");
+      const Name centers("centers");
+      const Name widths("widths");
+      const Name grid_min("grid_min");
+      const Name grid_max("grid_max");
+      const Name grid_size("grid_size");
+      const Name inputs("inputs");
+  }
+}
+
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::rbf_encoder::Parameters_::Parameters_()
+   : min_rate_( 1.0 ) // Hz
+   , max_rate_( 10.0 ) // Hz
+   , num_inputs_( 1 )
+   , centers_( 10 )
+   , widths_( 1, 0.1 ) // nA
+   , first_target_( 0 )
+{
+  // 10 centers evenly spread over [0, 1] nA
+  for ( size_t i = 0; i < centers_.size(); ++i )
+  {
+    centers_[ i ] = i / 9.0;
+  }
+}
+
+mynest::rbf_encoder::State_::State_(const Parameters_& p)
+  : inputs_( p.num_inputs_, 0.0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extractions and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void mynest::rbf_encoder::Parameters_::get(DictionaryDatum &d) const
+{
+  def< double >( d, nest::names::min_rate, min_rate_ );
+  def< double >( d, nest::names::max_rate, max_rate_ );
+  def< long >( d, nest::names::num_inputs, num_inputs_ );
+  def< long >( d, nest::names::num_centers, num_centers() );
+  def< std::vector<double> >( d, nest::names::centers, centers_ );
+  def< std::vector<double> >( d, nest::names::widths, widths_ );
+  def< long >( d, nest::names::first_target, first_target_ );
+}
+
+void mynest::rbf_encoder::Parameters_::set(const DictionaryDatum& d)
+{
+  updateValue< double >( d, nest::names::min_rate, min_rate_ );
+  updateValue< double >( d, nest::names::max_rate, max_rate_ );
+  updateValue< long >( d, nest::names::num_inputs, num_inputs_ );
+  updateValue< std::vector<double> >( d, nest::names::centers, centers_ );
+  updateValue< std::vector<double> >( d, nest::names::widths, widths_ );
+  updateValue< long >( d, nest::names::first_target, first_target_ );
+
+  if ( min_rate_ < 0 || max_rate_ < 0 )
+  {
+    throw nest::BadProperty( "The min_rate and max_rate parameters cannot be negative." );
+  }
+  if ( num_inputs_ < 1 )
+  {
+    throw nest::BadProperty( "The num_inputs parameter must be at least 1." );
+  }
+  if ( first_target_ < 0 )
+  {
+    throw nest::BadProperty( "The first_target parameter cannot be negative." );
+  }
+
+  // Replace the centers with a regular grid
+  std::vector<double> grid_min, grid_max;
+  std::vector<long> grid_size;
+  const bool has_min = updateValue< std::vector<double> >( d, nest::names::grid_min, grid_min );
+  const bool has_max = updateValue< std::vector<double> >( d, nest::names::grid_max, grid_max );
+  const bool has_size = updateValue< std::vector<long> >( d, nest::names::grid_size, grid_size );
+  if ( has_min || has_max || has_size )
+  {
+    const size_t n_inputs = num_inputs_;
+    if ( grid_min.size() != n_inputs || grid_max.size() != n_inputs || grid_size.size() != n_inputs )
+    {
+      throw nest::BadProperty( "grid_min, grid_max and grid_size must be set together, with one value per input." );
+    }
+
+    size_t n_centers = 1;
+    for ( size_t d_in = 0; d_in < n_inputs; ++d_in )
+    {
+      if ( grid_size[ d_in ] < 1 )
+      {
+        throw nest::BadProperty( "All the values of grid_size must be at least 1." );
+      }
+      n_centers *= grid_size[ d_in ];
+    }
+
+    centers_.resize( n_centers * n_inputs );
+    for ( size_t k = 0; k < n_centers; ++k )
+    {
+      // Position of the center along every input, with the last input
+      // varying fastest
+      size_t rest = k;
+      for ( size_t d_in = n_inputs; d_in-- > 0; )
+      {
+        const size_t i = rest % grid_size[ d_in ];
+        rest /= grid_size[ d_in ];
+        centers_[ k * n_inputs + d_in ] = ( grid_size[ d_in ] == 1 )
+          ? 0.5 * ( grid_min[ d_in ] + grid_max[ d_in ] )
+          : grid_min[ d_in ] + i * ( grid_max[ d_in ] - grid_min[ d_in ] ) / ( grid_size[ d_in ] - 1 );
+      }
+    }
+  }
+
+  if ( centers_.empty() || centers_.size() % num_inputs_ != 0 )
+  {
+    throw nest::BadProperty( "centers must contain num_inputs values for every center." );
+  }
+  if ( widths_.size() != static_cast< size_t >( num_inputs_ ) )
+  {
+    throw nest::BadProperty( "widths must contain one value per input." );
+  }
+  for ( size_t d_in = 0; d_in < widths_.size(); ++d_in )
+  {
+    if ( widths_[ d_in ] <= 0 )
+    {
+      throw nest::BadProperty( "All the widths must be strictly positive." );
+    }
+  }
+}
+
+void mynest::rbf_encoder::State_::get(DictionaryDatum &d) const
+{
+  def< std::vector<double> >(d, nest::names::inputs, inputs_);
+}
+
+void mynest::rbf_encoder::State_::set(const DictionaryDatum& d, const Parameters_& p)
+{
+  updateValue< std::vector<double> >(d, nest::names::inputs, inputs_);
+  inputs_.resize( p.num_inputs_, 0.0 );
+}
+
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node, and destructor
+ * ---------------------------------------------------------------- */
+
+mynest::rbf_encoder::rbf_encoder()
+  : DeviceNode()
+  , P_()
+  , S_(P_)
+  , B_()
+  , num_connected_inputs_( 0 )
+{
+}
+
+mynest::rbf_encoder::rbf_encoder(const rbf_encoder& n)
+  : DeviceNode( n )
+  , P_( n.P_ )
+  , S_( n.S_)
+  , B_()
+  , num_connected_inputs_( 0 )
+{
+}
+
+mynest::rbf_encoder::~rbf_encoder()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void mynest::rbf_encoder::init_state_(const Node& proto)
+{
+  const rbf_encoder& pr = downcast< rbf_encoder >( proto );
+
+  S_ = pr.S_;
+}
+
+void mynest::rbf_encoder::init_buffers_()
+{
+  B_.currents_.resize( P_.num_inputs_ );
+  for ( size_t d_in = 0; d_in < B_.currents_.size(); ++d_in )
+  {
+    B_.currents_[ d_in ].clear();
+  }
+
+  B_.step_ = nest::Time::get_resolution().get_ms();
+
+  B_.budget_.clear();
+  B_.n_spikes_.clear();
+}
+
+void mynest::rbf_encoder::calibrate()
+{
+  const size_t n_inputs = P_.num_inputs_;
+  const size_t n_centers = P_.num_centers();
+
+  if ( B_.currents_.size() != n_inputs )
+  {
+    B_.currents_.resize( n_inputs );
+    for ( size_t d_in = 0; d_in < n_inputs; ++d_in )
+    {
+      B_.currents_[ d_in ].clear();
+    }
+  }
+
+  V_.centers_by_input_.resize( n_centers * n_inputs );
+  for ( size_t k = 0; k < n_centers; ++k )
+  {
+    for ( size_t d_in = 0; d_in < n_inputs; ++d_in )
+    {
+      V_.centers_by_input_[ d_in * n_centers + k ] = P_.centers_[ k * n_inputs + d_in ];
+    }
+  }
+
+  V_.inv_two_var_.resize( n_inputs );
+  for ( size_t d_in = 0; d_in < n_inputs; ++d_in )
+  {
+    V_.inv_two_var_[ d_in ] = 1.0 / ( 2.0 * P_.widths_[ d_in ] * P_.widths_[ d_in ] );
+  }
+
+  V_.distance_.resize( n_centers );
+  V_.lambdas_.resize( n_centers );
+  compute_lambdas_();
+
+  // The budgets are drawn again if the number of centers changed
+  if ( B_.budget_.size() != n_centers )
+  {
+    B_.budget_.clear();
+  }
+  B_.n_spikes_.assign( n_centers, 0 );
+}
+
+void mynest::rbf_encoder::compute_lambdas_()
+{
+  const size_t n_inputs = V_.inv_two_var_.size();
+  const size_t n_centers = V_.lambdas_.size();
+  double* distance = V_.distance_.data();
+  double* lambdas = V_.lambdas_.data();
+
+  std::fill( V_.distance_.begin(), V_.distance_.end(), 0.0 );
+
+  for ( size_t d_in = 0; d_in < n_inputs; ++d_in )
+  {
+    const double* centers = V_.centers_by_input_.data() + d_in * n_centers;
+    const double input = S_.inputs_[ d_in ];
+    const double inv_two_var = V_.inv_two_var_[ d_in ];
+
+#pragma omp simd
+    for ( size_t k = 0; k < n_centers; ++k )
+    {
+      const double diff = input - centers[ k ];
+      distance[ k ] += diff * diff * inv_two_var;
+    }
+  }
+
+  // rate is in Hz, dt in ms, so we have to convert from s to ms
+  const float lambda_min = B_.step_ * P_.min_rate_ * 1e-3;
+  const float lambda_range = B_.step_ * ( P_.max_rate_ - P_.min_rate_ ) * 1e-3;
+
+  // The look-up table is accessed directly (instead of through GetResult)
+  // to keep the loop free of branches and calls. The exponent is never
+  // positive, and exponents below the table are clamped to its first value,
+  // exp(Min), which is negligible.
+  const float* ExpLUT = ExponentialTable::LookUpTable;
+  const float ExpMin = ExponentialTable::Min;
+  const float ExpAux = ExponentialTable::aux;
+
+#pragma omp simd
+  for ( size_t k = 0; k < n_centers; ++k )
+  {
+    const float ExpValue = std::max( -static_cast< float >( distance[ k ] ), ExpMin );
+    const int ExpPosition = int( ( ExpValue - ExpMin ) * ExpAux );
+    lambdas[ k ] = lambda_min + lambda_range * ExpLUT[ ExpPosition ];
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and spike handling functions
+ * ---------------------------------------------------------------- */
+
+void mynest::rbf_encoder::update(nest::Time const & T, const long from, const long to)
+{
+
+  assert(
+    to >= 0 && ( nest::delay ) from < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  librandom::RngPtr rng = nest::kernel().rng_manager.get_rng( get_thread() );
+
+  const size_t n_inputs = B_.currents_.size();
+  const size_t n_centers = V_.lambdas_.size();
+
+  if ( B_.budget_.size() != n_centers )
+  {
+    B_.budget_.resize( n_centers );
+    for ( size_t k = 0; k < n_centers; ++k )
+    {
+      B_.budget_[ k ] = V_.exp_dev_( rng );
+    }
+  }
+
+  double* budget = B_.budget_.data();
+  const double* lambdas = V_.lambdas_.data();
+
+  for ( long lag = from; lag < to; ++lag)
+  {
+    // Update the firing rates only when an input changes
+    bool changed = false;
+    for ( size_t d_in = 0; d_in < n_inputs; ++d_in )
+    {
+      const double new_input = B_.currents_[ d_in ].get_value( lag );
+      if ( S_.inputs_[ d_in ] != new_input )
+      {
+        S_.inputs_[ d_in ] = new_input;
+        changed = true;
+      }
+    }
+
+    if ( changed )
+    {
+      compute_lambdas_();
+    }
+
+    // Spend the expected spikes of this step
+    double min_budget = 1.0;
+#pragma omp simd reduction( min : min_budget )
+    for ( size_t k = 0; k < n_centers; ++k )
+    {
+      budget[ k ] -= lambdas[ k ];
+      min_budget = std::min( min_budget, budget[ k ] );
+    }
+
+    if ( min_budget <= 0.0 )
+    {
+      for ( size_t k = 0; k < n_centers; ++k )
+      {
+        while ( budget[ k ] <= 0.0 )
+        {
+          ++B_.n_spikes_[ k ];
+          budget[ k ] += V_.exp_dev_( rng );
+        }
+      }
+
+      // The spikes of every target are sent in event_hook, during the
+      // delivery of this event
+      nest::DSSpikeEvent e;
+      nest::kernel().event_delivery_manager.send( *this, e, lag );
+
+      std::fill( B_.n_spikes_.begin(), B_.n_spikes_.end(), 0 );
+    }
+  }
+}
+
+void mynest::rbf_encoder::event_hook(nest::DSSpikeEvent& e)
+{
+  const long center = static_cast< long >( e.get_receiver().get_gid() ) - P_.first_target_;
+
+  if ( center < 0 || center >= static_cast< long >( B_.n_spikes_.size() ) )
+  {
+    return;
+  }
+
+  const unsigned int n_spikes = B_.n_spikes_[ center ];
+
+  if ( n_spikes > 0 ) // we must not send events with multiplicity 0
+  {
+    e.set_multiplicity( n_spikes );
+    e.get_receiver().handle( e );
+  }
+}
+
+void mynest::rbf_encoder::handle(nest::CurrentEvent& e)
+{
+  assert(e.get_delay_steps() > 0);
+
+  const double c=e.get_current();
+  const double w=e.get_weight();
+
+  B_.currents_[ e.get_rport() ].add_value(e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin()),
+          w *c);
+}
@@ -0,0 +1,309 @@
+/*
+ *  rbf_encoder.h
+ *
+ *  This file is based on the poisson generator model distributed with NEST.
+ */
+
+#ifndef RBF_ENCODER_H
+#define RBF_ENCODER_H
+
+// Includes from librandom:
+#include "exp_randomdev.h"
+
+// Includes from nestkernel:
+#include "connection.h"
+#include "event.h"
+#include "nest_types.h"
+#include "device_node.h"
+#include "ring_buffer.h"
+
+#include <algorithm>
+#include <vector>
+
+/* BeginDocumentation
+Name: rbf_encoder - simulate a population of neurons firing with Poisson
+                    statistics driven by a vector of input currents through
+                    multi-dimensional gaussian receptive fields.
+Description:
+  The rbf_encoder encodes num_inputs analog inputs, e.g. the position and
+  velocity of the joints of a robot arm, with a set of gaussian receptive
+  fields in the input space. The input d is the sum of the currents received
+  through receptor port d. The firing rate of the receptive field k with
+  center c_k is
+
+    rate_k = min_rate + (max_rate - min_rate) * exp(-sum_d (x_d - c_kd)^2 / (2 w_d^2))
+
+  and each of them fires with Poisson statistics. The target with id g
+  receives the spike train of the receptive field g - first_target, as in
+  rbf_poisson_generator. Targets whose receptive field does not exist
+  receive no spikes.
+
+  The centers are either given explicitly with centers, or generated as a
+  regular grid with grid_min, grid_max and grid_size.
+
+Parameters:
+   The following parameters appear in the element's status dictionary:
+
+   num_inputs   int          - Number of analog inputs (receptor ports)
+   centers      double array - Coordinates of the centers, one center after
+                               the other (num_centers x num_inputs values)
+   widths       double array - Width of the receptive fields along every input
+   grid_min     double array - Coordinates of the first center of the grid
+   grid_max     double array - Coordinates of the last center of the grid
+   grid_size    int array    - Number of centers of the grid along every input.
+                               Setting grid_min, grid_max and grid_size
+                               replaces the centers with the grid, with the
+                               last input varying fastest. The grid
+                               parameters are write only.
+   num_centers  int          - Number of receptive fields (read only)
+   first_target int          - Id of the target that receives the receptive
+                               field 0
+   max_rate     double       - Firing rate at the center of a receptive field
+                               in Hz
+   min_rate     double       - Firing rate far from the centers in Hz
+   inputs       double array - Current value of the inputs
+
+Sends: SpikeEvent
+
+Receives: CurrentEvent
+
+Remarks:
+   The rates are computed in a single vectorized pass over the receptive
+   fields whenever an input changes, with the exponential function taken
+   from the ExponentialTable look-up table. The spikes are generated by time
+   rescaling, as in rbf_poisson_generator, so random numbers are only drawn
+   when a spike is emitted.
+
+   num_inputs must be set before the inputs are connected. Afterwards it can
+   be raised, but not lowered below the receptor ports already connected.
+
+   As with poisson_generator, the spike trains can only be sent through
+   synapse models that support DSSpikeEvent, such as static_synapse.
+
+SeeAlso: rbf_poisson_generator, cd_poisson_generator
+*/
+
+// Define name constants for state variables and parameters
+namespace nest
+{
+	namespace names
+	{
+    	// Neuron parameters
+    	extern const Name min_rate;
+    	extern const Name max_rate;
+      extern const Name num_centers;
+      extern const Name num_inputs;
+      extern const Name centers;
+      extern const Name widths;
+      extern const Name grid_min;
+      extern const Name grid_max;
+      extern const Name grid_size;
+      extern const Name inputs;
+      extern const Name first_target;
+    }
+}
+
+namespace mynest
+{
+  class rbf_encoder : public nest::DeviceNode
+  {
+
+  public:
+
+    rbf_encoder();
+    rbf_encoder(const rbf_encoder&);
+    ~rbf_encoder();
+
+    /**
+     * Import sets of overloaded virtual functions.
+     * We need to explicitly include sets of overloaded
+     * virtual functions into the current scope.
+     * According to the SUN C++ FAQ, this is the correct
+     * way of doing things, although all other compilers
+     * happily live without.
+     */
+
+    using nest::Node::handles_test_event;
+    using nest::Node::handle;
+    using nest::Node::event_hook;
+
+    nest::port send_test_event(nest::Node&, nest::rport, nest::synindex, bool);
+
+    void handle(nest::CurrentEvent &);
+
+    nest::port handles_test_event(nest::CurrentEvent &, nest::rport);
+
+
+    void get_status(DictionaryDatum &) const;
+    void set_status(const DictionaryDatum &);
+
+  private:
+    void init_state_(const Node& proto);
+    void init_buffers_();
+    void calibrate();
+
+    void update(nest::Time const &, const long, const long);
+
+    /**
+     * Send the spikes of the receptive field of a single target.
+     */
+    void event_hook(nest::DSSpikeEvent&);
+
+    // Compute the expected number of spikes per step of every receptive
+    // field for the current inputs
+    void compute_lambdas_();
+
+    // END Boilerplate function declarations ----------------------------
+
+  private:
+
+    /**
+      * Store independent parameters of the model.
+      */
+    struct Parameters_{
+      double min_rate_;
+      double max_rate_;
+      long num_inputs_;
+
+      //! Coordinates of the centers, center after center
+      std::vector<double> centers_;
+
+      //! Width of the receptive fields along every input
+      std::vector<double> widths_;
+
+      //! Id of the target of the receptive field 0
+      long first_target_;
+
+      Parameters_(); //!< Sets default parameter values
+
+      void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+      void set( const DictionaryDatum& ); //!< Set values from dicitonary
+
+      size_t num_centers() const { return centers_.size() / num_inputs_; }
+    };
+
+  public:
+    // ----------------------------------------------------------------
+
+    /**
+     * State variables of the model.
+     */
+    struct State_ {
+
+      //! Current value of every input
+      std::vector<double> inputs_;
+
+      State_(const Parameters_&);  //!< Default initialization
+
+      void get(DictionaryDatum&) const;
+      void set(const DictionaryDatum&, const Parameters_&);
+    };
+
+    // ----------------------------------------------------------------
+
+  private:
+
+    /**
+     * Buffers of the model.
+     */
+    struct Buffers_ {
+      /** buffers and sums up incoming currents, one buffer per input */
+      std::vector<nest::RingBuffer> currents_;
+
+      double step_;           //!< step size in ms
+
+      //! Expected number of spikes left before the next spike of every
+      //! receptive field. Empty until it is drawn in the first update.
+      std::vector<double> budget_;
+
+      //! Number of spikes of every receptive field in the current step
+      std::vector<unsigned int> n_spikes_;
+    };
+
+  // ------------------------------------------------------------
+
+    struct Variables_
+    {
+      librandom::ExpRandomDev exp_dev_; //!< Random deviate generator
+
+      //! Coordinates of the centers, input after input, so that the
+      //! coordinates of all the centers along one input are contiguous
+      std::vector<double> centers_by_input_;
+
+      //! 1 / (2 w_d^2) for every input
+      std::vector<double> inv_two_var_;
+
+      //! Squared distance of every center to the inputs, scaled by the widths
+      std::vector<double> distance_;
+
+      //! Expected number of spikes per step of every receptive field
+      std::vector<double> lambdas_;
+    };
+
+  // ------------------------------------------------------------
+
+    Parameters_ P_;
+    Variables_ V_;
+    State_ S_;
+    Buffers_ B_;
+
+    //! Number of inputs that have connections, i.e. the highest connected
+    //! receptor port + 1. Connections survive ResetNetwork, so it is not
+    //! part of the state.
+    long num_connected_inputs_;
+
+  };
+
+
+  inline
+  nest::port rbf_encoder::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex, bool dummy_target)
+  {
+    // The dummy target tells whether the synapse model supports
+    // DSSpikeEvent, which carries the individual spike trains
+    if ( dummy_target )
+    {
+      nest::DSSpikeEvent e;
+      e.set_sender( *this );
+      return target.handles_test_event( e, receptor_type );
+    }
+
+  	nest::SpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+
+  inline
+  nest::port rbf_encoder::handles_test_event(nest::CurrentEvent&, nest::rport receptor_type)
+  {
+    if (receptor_type < 0 || receptor_type >= P_.num_inputs_)
+      throw nest::UnknownReceptorType(receptor_type, get_name());
+    num_connected_inputs_ = std::max( num_connected_inputs_, receptor_type + 1 );
+    return receptor_type;
+  }
+
+  inline
+  void rbf_encoder::get_status(DictionaryDatum &d) const
+  {
+    P_.get(d);
+    S_.get(d);
+  }
+
+  inline
+  void rbf_encoder::set_status(const DictionaryDatum &d)
+  {
+    Parameters_ ptmp = P_;  // temporary copy in case of errors
+    ptmp.set(d);                       // throws if BadProperty
+    if ( ptmp.num_inputs_ < num_connected_inputs_ )
+      throw nest::BadProperty( "num_inputs cannot be lowered below the receptor ports already connected." );
+    State_      stmp = S_;  // temporary copy in case of errors
+    stmp.set(d, ptmp);
+
+    // if we get here, temporaries contain consistent set of properties
+    P_ = ptmp;
+    S_ = stmp;
+
+  }
+
+} // namespace
+
+#endif //RBF_ENCODER_H
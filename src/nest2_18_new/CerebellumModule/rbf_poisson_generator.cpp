@@ -2,7 +2,7 @@
  *  rbf_poisson_generator.cpp
  *
  *  This file is based on the iaf_cond_exp cell model distributed with NEST.
- *  
+ *
  *  Modified by: Jesus Garrido (jgarridoalcazar at gmail.com) in 2017.
  */
 
@@ -20,9 +20,13 @@
 #include "dict.h"
 #include "dictutils.h"
 #include "doubledatum.h"
+#include "integerdatum.h"
+
+#include <algorithm>
+#include <cmath>
 
 
-/* ---------------------------------------------------------------- 
+/* ----------------------------------------------------------------
  * Recordables map
  * ---------------------------------------------------------------- */
 
@@ -31,95 +35,109 @@ nest::RecordablesMap<mynest::rbf_poisson_generator> mynest::rbf_poisson_generato
 
 namespace nest  // template specialization must be placed in namespace
 {
-  // Override the create() method with one call to RecordablesMap::insert_() 
+  // Override the create() method with one call to RecordablesMap::insert_()
   // for each quantity to be recorded.
   template <>
   void RecordablesMap<mynest::rbf_poisson_generator>::create()
   {
-    // use standard names whereever you can for consistency!
-    insert_(names::rate,
-    &mynest::rbf_poisson_generator::get_rate_);
-
     // use standard names whereever you can for consistency!
     insert_(names::I,
     &mynest::rbf_poisson_generator::get_current_);
   }
-  
+
   namespace names
   {
-
+      const Name num_centers("num_centers");
+      const Name gau_width("gau_width");
   }
 }
 
 
-/* ---------------------------------------------------------------- 
+/* ----------------------------------------------------------------
  * Default constructors defining default parameters and state
  * ---------------------------------------------------------------- */
-    
+
 mynest::rbf_poisson_generator::Parameters_::Parameters_()
-   : min_rate_rbf_( 1.0 ) // Hz
-   , max_rate_rbf_( 10.0 ) // Hz
-   , mean_current_rbf_( 0.0 ) // nA
-   , sigma_current_rbf_( 1.0 ) // nA
+   : min_rate_( 1.0 ) // Hz
+   , max_rate_( 10.0 ) // Hz
+   , min_current_( 0.0 ) // nA
+   , max_current_( 1.0 ) // nA
+   , gau_width_( 0.1 ) // nA
+   , num_centers_( 10 )
+   , first_target_( 0 )
 {
 }
 
-mynest::rbf_poisson_generator::State_::State_(const Parameters_& p)
-  : rate_(5.0),
-  input_current_(0.0)  
+mynest::rbf_poisson_generator::State_::State_(const Parameters_&)
+  : input_current_(0.0)
 {
 }
 
 mynest::rbf_poisson_generator::State_::State_(const State_& s)
-  : rate_(s.rate_),
-  input_current_(s.input_current_)
+  : input_current_(s.input_current_)
 {
 }
 
-/* ---------------------------------------------------------------- 
+/* ----------------------------------------------------------------
  * Parameter and state extractions and manipulation functions
  * ---------------------------------------------------------------- */
 
-void mynest::cd_poisson_generator::Parameters_::get(DictionaryDatum &d) const
+void mynest::rbf_poisson_generator::Parameters_::get(DictionaryDatum &d) const
 {
-	def< double >( d, nest::names::min_rate, min_rate_ );
+  def< double >( d, nest::names::min_rate, min_rate_ );
   def< double >( d, nest::names::max_rate, max_rate_ );
   def< double >( d, nest::names::min_current, min_current_ );
   def< double >( d, nest::names::max_current, max_current_ );
+  def< double >( d, nest::names::gau_width, gau_width_ );
+  def< long >( d, nest::names::num_centers, num_centers_ );
+  def< long >( d, nest::names::first_target, first_target_ );
 }
 
-void mynest::cd_poisson_generator::Parameters_::set(const DictionaryDatum& d)
+void mynest::rbf_poisson_generator::Parameters_::set(const DictionaryDatum& d)
 {
-	def< double >( d, nest::names::min_rate_rbf, min_rate_rbf_ );
-  def< double >( d, nest::names::max_rate_rbf, max_rate_rbf_ );
-  def< double >( d, nest::names::mean_current_rbf, mean_current_rbf_ );
-  def< double >( d, nest::names::sigma_current_rbf, sigma_current_rbf_ );
-  if ( min_rate_rbf_ < 0 || max_rate_rbf_ < 0 || min_rate_rbf_ > max_rate_rbf_ )
+  updateValue< double >( d, nest::names::min_rate, min_rate_ );
+  updateValue< double >( d, nest::names::max_rate, max_rate_ );
+  updateValue< double >( d, nest::names::min_current, min_current_ );
+  updateValue< double >( d, nest::names::max_current, max_current_ );
+  updateValue< double >( d, nest::names::gau_width, gau_width_ );
+  updateValue< long >( d, nest::names::num_centers, num_centers_ );
+  updateValue< long >( d, nest::names::first_target, first_target_ );
+  if ( min_rate_ < 0 || max_rate_ < 0 )
   {
     throw nest::BadProperty( "The min_rate and max_rate parameters cannot be negative." );
   }
+  if ( gau_width_ <= 0 )
+  {
+    throw nest::BadProperty( "The gau_width parameter must be strictly positive." );
+  }
+  if ( num_centers_ < 1 )
+  {
+    throw nest::BadProperty( "The num_centers parameter must be at least 1." );
+  }
+  if ( first_target_ < 0 )
+  {
+    throw nest::BadProperty( "The first_target parameter cannot be negative." );
+  }
 }
 
-void mynest::cd_poisson_generator::State_::get(DictionaryDatum &d) const
+void mynest::rbf_poisson_generator::State_::get(DictionaryDatum &d) const
 {
-  def<double>(d, nest::names::rate, rate_);
   def<double>(d, nest::names::I, input_current_);
 }
 
-void mynest::cd_poisson_generator::State_::set(const DictionaryDatum& d, const Parameters_&)
+void mynest::rbf_poisson_generator::State_::set(const DictionaryDatum& d, const Parameters_&)
 {
-  updateValue<double>(d, nest::names::rate, rate_);
   updateValue<double>(d, nest::names::I, input_current_);
 }
 
-mynest::cd_poisson_generator::Buffers_::Buffers_(mynest::cd_poisson_generator& n)
+mynest::rbf_poisson_generator::Buffers_::Buffers_(mynest::rbf_poisson_generator& n)
   : logger_(n)
 {
   // Initialization of the remaining members is deferred to
   // init_buffers_().
 }
 
-mynest::cd_poisson_generator::Buffers_::Buffers_(const Buffers_&, cd_poisson_generator& n)
+mynest::rbf_poisson_generator::Buffers_::Buffers_(const Buffers_&, rbf_poisson_generator& n)
   : logger_(n)
 {
   // Initialization of the remaining members is deferred to
@@ -127,12 +145,12 @@ mynest::cd_poisson_generator::Buffers_::Buffers_(const Buffers_&, cd_poisson_gen
 }
 
 
-/* ---------------------------------------------------------------- 
+/* ----------------------------------------------------------------
  * Default and copy constructor for node, and destructor
  * ---------------------------------------------------------------- */
 
-mynest::cd_poisson_generator::cd_poisson_generator()
-  : Node()
+mynest::rbf_poisson_generator::rbf_poisson_generator()
+  : DeviceNode()
   , P_()
   , S_(P_)
   , B_(*this)
@@ -140,113 +158,193 @@ mynest::cd_poisson_generator::cd_poisson_generator()
   recordablesMap_.create();
 }
 
-mynest::cd_poisson_generator::cd_poisson_generator(const cd_poisson_generator& n)
-  : Node( n )
+mynest::rbf_poisson_generator::rbf_poisson_generator(const rbf_poisson_generator& n)
+  : DeviceNode( n )
   , P_( n.P_ )
   , S_( n.S_)
   , B_( n.B_, *this)
 {
 }
 
-mynest::cd_poisson_generator::~cd_poisson_generator()
+mynest::rbf_poisson_generator::~rbf_poisson_generator()
 {
 }
 
-/* ---------------------------------------------------------------- 
+/* ----------------------------------------------------------------
  * Node initialization functions
  * ---------------------------------------------------------------- */
 
-void mynest::cd_poisson_generator::init_state_(const Node& proto)
+void mynest::rbf_poisson_generator::init_state_(const Node& proto)
 {
-  const cd_poisson_generator& pr = downcast< cd_poisson_generator >( proto );
+  const rbf_poisson_generator& pr = downcast< rbf_poisson_generator >( proto );
 
   S_ = pr.S_;
 }
 
-void mynest::cd_poisson_generator::init_buffers_()
+void mynest::rbf_poisson_generator::init_buffers_()
 {
   B_.currents_.clear();
 
   B_.logger_.reset();
 
   B_.step_ = nest::Time::get_resolution().get_ms();
+
+  B_.budget_.clear();
+  B_.n_spikes_.clear();
 }
 
-void mynest::cd_poisson_generator::calibrate()
+void mynest::rbf_poisson_generator::calibrate()
 {
   B_.logger_.init();
 
-  double gaussian = std::exp(-((S_.input_current_ - P_.mean_current_rbf_) * (S_.input_current_ - P_.mean_current_rbf_))/((2.0 * P_.sigma_current_rbf_ * P_.sigma_current_rbf_)));
-  S_.rate_ = P_.min_rate_rbf_ + gaussian * (P_.max_rate_rbf_ - P_.min_rate_rbf_);
+  const size_t n_centers = P_.num_centers_;
+
+  V_.centers_.resize( n_centers );
+  if ( n_centers == 1 )
+  {
+    V_.centers_[ 0 ] = 0.5 * ( P_.min_current_ + P_.max_current_ );
+  }
+  else
+  {
+    const double spacing = ( P_.max_current_ - P_.min_current_ ) / ( n_centers - 1 );
+    for ( size_t i = 0; i < n_centers; ++i )
+    {
+      V_.centers_[ i ] = P_.min_current_ + i * spacing;
+    }
+  }
+
+  V_.lambdas_.resize( n_centers );
+  compute_lambdas_();
+
+  // The budgets are drawn again if the number of centers changed
+  if ( B_.budget_.size() != n_centers )
+  {
+    B_.budget_.clear();
+  }
+  B_.n_spikes_.assign( n_centers, 0 );
+}
+
+void mynest::rbf_poisson_generator::compute_lambdas_()
+{
+  const size_t n_centers = V_.centers_.size();
+  const double* centers = V_.centers_.data();
+  double* lambdas = V_.lambdas_.data();
 
   // rate_ is in Hz, dt in ms, so we have to convert from s to ms
-  V_.poisson_dev_.set_lambda(
-    nest::Time::get_resolution().get_ms() * S_.rate_ * 1e-3 );
+  const double lambda_min = B_.step_ * P_.min_rate_ * 1e-3;
+  const double lambda_range = B_.step_ * ( P_.max_rate_ - P_.min_rate_ ) * 1e-3;
+  const double inv_two_var = 1.0 / ( 2.0 * P_.gau_width_ * P_.gau_width_ );
+  const double current = S_.input_current_;
+
+#pragma omp simd
+  for ( size_t i = 0; i < n_centers; ++i )
+  {
+    const double diff = current - centers[ i ];
+    lambdas[ i ] = lambda_min + lambda_range * std::exp( -diff * diff * inv_two_var );
+  }
 }
 
-/* ---------------------------------------------------------------- 
+/* ----------------------------------------------------------------
  * Update and spike handling functions
  * ---------------------------------------------------------------- */
 
-void mynest::cd_poisson_generator::update(nest::Time const & T, const long from, const long to)
+void mynest::rbf_poisson_generator::update(nest::Time const & T, const long from, const long to)
 {
-   
+
   assert(
     to >= 0 && ( nest::delay ) from < nest::kernel().connection_manager.get_min_delay() );
   assert( from < to );
 
   librandom::RngPtr rng = nest::kernel().rng_manager.get_rng( get_thread() );
 
+  const size_t n_centers = V_.lambdas_.size();
+
+  if ( B_.budget_.size() != n_centers )
+  {
+    B_.budget_.resize( n_centers );
+    for ( size_t i = 0; i < n_centers; ++i )
+    {
+      B_.budget_[ i ] = V_.exp_dev_( rng );
+    }
+  }
+
+  double* budget = B_.budget_.data();
+  const double* lambdas = V_.lambdas_.data();
+
   for ( long lag = from; lag < to; ++lag)
   {
     double new_current = B_.currents_.get_value(lag);
 
-    // Update the firing rate only when the input current changes
+    // Update the firing rates only when the input current changes
     if (S_.input_current_!= new_current){
-
       S_.input_current_ = new_current;
-      
-      double gaussian = std::exp(-((S_.input_current_ - P_.mean_current_rbf_) * (S_.input_current_ - P_.mean_current_rbf_))/((2.0 * P_.sigma_current_rbf_ * P_.sigma_current_rbf_)));
-      S_.rate_ = P_.min_rate_rbf_ + gaussian * (P_.max_rate_rbf_ - P_.min_rate_rbf_);
-
-      // Lambda device frequency is updated only once per call to update.
-      V_.poisson_dev_.set_lambda(
-        nest::Time::get_resolution().get_ms() * S_.rate_ * 1e-3 );
+      compute_lambdas_();
     }
 
-      
-    if (S_.rate_ > 0.0){
-      long n_spikes = V_.poisson_dev_.ldev( rng );
+    // Spend the expected spikes of this step
+    double min_budget = 1.0;
+#pragma omp simd reduction( min : min_budget )
+    for ( size_t i = 0; i < n_centers; ++i )
+    {
+      budget[ i ] -= lambdas[ i ];
+      min_budget = std::min( min_budget, budget[ i ] );
+    }
 
-      if ( n_spikes > 0 ) // we must not send events with multiplicity 0
+    if ( min_budget <= 0.0 )
+    {
+      for ( size_t i = 0; i < n_centers; ++i )
       {
-        nest::SpikeEvent e;
-        e.set_multiplicity( n_spikes );
-        nest::kernel().event_delivery_manager.send( *this, e, lag );
+        while ( budget[ i ] <= 0.0 )
+        {
+          ++B_.n_spikes_[ i ];
+          budget[ i ] += V_.exp_dev_( rng );
+        }
       }
+
+      // The spikes of every target are sent in event_hook, during the
+      // delivery of this event
+      nest::DSSpikeEvent e;
+      nest::kernel().event_delivery_manager.send( *this, e, lag );
+
+      std::fill( B_.n_spikes_.begin(), B_.n_spikes_.end(), 0 );
     }
- 
+
     // log state data
     B_.logger_.record_data(T.get_steps() + lag);
   }
+}
 
+void mynest::rbf_poisson_generator::event_hook(nest::DSSpikeEvent& e)
+{
+  const long center = static_cast< long >( e.get_receiver().get_gid() ) - P_.first_target_;
 
+  if ( center < 0 || center >= static_cast< long >( B_.n_spikes_.size() ) )
+  {
+    return;
+  }
+
+  const unsigned int n_spikes = B_.n_spikes_[ center ];
+
+  if ( n_spikes > 0 ) // we must not send events with multiplicity 0
+  {
+    e.set_multiplicity( n_spikes );
+    e.get_receiver().handle( e );
+  }
 }
 
-void mynest::cd_poisson_generator::handle(nest::CurrentEvent& e)
+void mynest::rbf_poisson_generator::handle(nest::CurrentEvent& e)
 {
-  assert(e.get_delay() > 0);
+  assert(e.get_delay_steps() > 0);
 
   const double c=e.get_current();
   const double w=e.get_weight();
 
   // add weighted current; HEP 2002-10-04
-  B_.currents_.add_value(e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin()), 
+  B_.currents_.add_value(e.get_rel_delivery_steps(nest::kernel().simulation_manager.get_slice_origin()),
           w *c);
 }
 
-void mynest::cd_poisson_generator::handle(nest::DataLoggingRequest& e)
+void mynest::rbf_poisson_generator::handle(nest::DataLoggingRequest& e)
 {
   B_.logger_.handle(e);
 }
-
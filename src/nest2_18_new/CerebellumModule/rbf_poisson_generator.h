@@ -2,7 +2,7 @@
  *  rbf_poisson_generator.h
  *
  *  This file is based on the poisson generator model distributed with NEST.
- *  
+ *
  *  Modified by: Jesús Garrido (jgarridoalcazar at gmail.com) in 2017.
  */
 
@@ -10,49 +10,67 @@
 #define RBF_POISSON_GENERATOR_H
 
 // Includes from librandom:
-#include "poisson_randomdev.h"
+#include "exp_randomdev.h"
 
 // Includes from nestkernel:
 #include "connection.h"
 #include "event.h"
 #include "nest_types.h"
-#include "node.h"
-#include "stimulating_device.h"
+#include "device_node.h"
 #include "ring_buffer.h"
 #include "universal_data_logger.h"
 
+#include <vector>
+
 /* BeginDocumentation
-Name: rbf_poisson_generator - simulate neuron firing with Poisson processes
-                          statistics drive by input current according to a gaussian
-                          function.
+Name: rbf_poisson_generator - simulate a population of neurons firing with
+                          Poisson statistics driven by input current through
+                          gaussian receptive fields.
 Description:
-  The rbf_poisson_generator simulates a neuron that is firing with Poisson
-  statistics, i.e. exponentially distributed interspike intervals. Its firing
-  rate is linearly calculated based on the total amount of input current. It will
-  generate a _unique_ spike train for each of it's targets. If you do not want
-  this behavior and need the same spike train for all targets, you have to use a
-  parrot neuron inbetween the poisson generator and the targets.
+  The rbf_poisson_generator encodes its input current with a bank of
+  num_centers gaussian receptive fields, whose centers are evenly spread over
+  [min_current, max_current]. The firing rate of the receptive field i is
+
+    rate_i = min_rate + (max_rate - min_rate) * exp(-(I - c_i)^2 / (2 gau_width^2))
+
+  and each of them fires with Poisson statistics. The target with id g
+  receives the spike train of the receptive field g - first_target, so a
+  single generator drives a whole population of mossy fibers.
 
 Parameters:
    The following parameters appear in the element's status dictionary:
 
-   origin     double - Time origin for device timer in ms
-   start      double - begin of device application with resp. to origin in ms
-   stop       double - end of device application with resp. to origin in ms
-   gau_center double - Input current matching the center of the gaussian function
-   gau_width  double - Width of the gaussian function
-   max_rate   double - Maximum firing rate generated by the poisson generator.
-   min_rate   double - Minimum firing rate generated by the poisson generator.
+   num_centers  int    - Number of receptive fields
+   first_target int    - Id of the target that receives the receptive field 0
+   min_current  double - Input current matching the first center
+   max_current  double - Input current matching the last center
+   gau_width    double - Width of the gaussian receptive fields
+   max_rate     double - Firing rate at the center of a receptive field in Hz
+   min_rate     double - Firing rate far from the center of a receptive field
+                         in Hz
 
 Sends: SpikeEvent
 
 Remarks:
-   A Poisson generator may, especially at high rates, emit more than one
+   A receptive field may, especially at high rates, emit more than one
    spike during a single time step. If this happens, the generator does
    not actually send out n spikes. Instead, it emits a single spike with
    n-fold synaptic weight for the sake of efficiency.
 
-SeeAlso: poisson_generator, Device, parrot_neuron
+   The mapping from targets to receptive fields only depends on the target
+   ids, so it does not change with the number of threads or the order of the
+   connections. Targets whose receptive field does not exist receive no
+   spikes.
+
+   The spikes are generated by time rescaling: every receptive field keeps
+   an exponentially distributed amount of expected spikes left before its
+   next spike, which decreases by its rate every step. Random numbers are
+   only drawn when a spike is emitted, also when the rates change.
+
+   As with poisson_generator, the spike trains can only be sent through
+   synapse models that support DSSpikeEvent, such as static_synapse.
+
+SeeAlso: cd_poisson_generator, poisson_generator, Device
 */
 
 // Define name constants for state variables and parameters
@@ -61,20 +79,23 @@ namespace nest
 	namespace names
 	{
     	// Neuron parameters
-    	extern const Name min_rate;  
-    	extern const Name max_rate;  
-      extern const Name gau_center;
+    	extern const Name min_rate;
+    	extern const Name max_rate;
+      extern const Name min_current;
+      extern const Name max_current;
+      extern const Name num_centers;
       extern const Name gau_width;
+      extern const Name first_target;
     }
 }
 
 namespace mynest
 {
-  class rbf_poisson_generator : public nest::Node
+  class rbf_poisson_generator : public nest::DeviceNode
   {
-    
-  public:        
-    
+
+  public:
+
     rbf_poisson_generator();
     rbf_poisson_generator(const rbf_poisson_generator&);
     ~rbf_poisson_generator();
@@ -90,26 +111,36 @@ namespace mynest
 
     using nest::Node::handles_test_event;
     using nest::Node::handle;
+    using nest::Node::event_hook;
 
     nest::port send_test_event(nest::Node&, nest::rport, nest::synindex, bool);
 
     void handle(nest::CurrentEvent &);
-    void handle(nest::DataLoggingRequest &); 
-    
+    void handle(nest::DataLoggingRequest &);
+
     nest::port handles_test_event(nest::CurrentEvent &, nest::rport);
     nest::port handles_test_event(nest::DataLoggingRequest &, nest::rport);
 
-    
+
     void get_status(DictionaryDatum &) const;
     void set_status(const DictionaryDatum &);
-    
+
   private:
     void init_state_(const Node& proto);
     void init_buffers_();
     void calibrate();
-    
+
     void update(nest::Time const &, const long, const long);
-    
+
+    /**
+     * Send the spikes of the receptive field of a single target.
+     */
+    void event_hook(nest::DSSpikeEvent&);
+
+    // Compute the expected number of spikes per step of every receptive
+    // field for the current input current
+    void compute_lambdas_();
+
     // END Boilerplate function declarations ----------------------------
 
     // Friends --------------------------------------------------------
@@ -123,11 +154,16 @@ namespace mynest
       * Store independent parameters of the model.
       */
     struct Parameters_{
-      double min_rate_rbf_;
-      double max_rate_rbf_;
-      double mean_current_rbf_;
-      double sigma_current_rbf_;
-      
+      double min_rate_;
+      double max_rate_;
+      double min_current_;
+      double max_current_;
+      double gau_width_;
+      long num_centers_;
+
+      //! Id of the target of the receptive field 0
+      long first_target_;
+
       Parameters_(); //!< Sets default parameter values
 
       void get( DictionaryDatum& ) const; //!< Store current values in dictionary
@@ -135,27 +171,23 @@ namespace mynest
     };
 
   public:
-    // ---------------------------------------------------------------- 
+    // ----------------------------------------------------------------
 
     /**
      * State variables of the model.
-     * @note Copy constructor and assignment operator required because
-     *       of C-style array.
      */
     struct State_ {
 
-      double rate_; 
-
-      double input_current_; 
+      double input_current_;
 
       State_(const Parameters_&);  //!< Default initialization
       State_(const State_&);
-      
+
       void get(DictionaryDatum&) const;
       void set(const DictionaryDatum&, const Parameters_&);
-    };    
+    };
 
-    // ---------------------------------------------------------------- 
+    // ----------------------------------------------------------------
 
   private:
 
@@ -172,24 +204,30 @@ namespace mynest
       /** buffers and sums up incoming spikes/currents */
       nest::RingBuffer currents_;
 
-      // IntergrationStep_ should be reset with the neuron on ResetNetwork,
-      // but remain unchanged during calibration. Since it is initialized with
-      // step_, and the resolution cannot change after nodes have been created,
-      // it is safe to place both here.
       double step_;           //!< step size in ms
+
+      //! Expected number of spikes left before the next spike of every
+      //! receptive field. Empty until it is drawn in the first update.
+      std::vector<double> budget_;
+
+      //! Number of spikes of every receptive field in the current step
+      std::vector<unsigned int> n_spikes_;
     };
 
   // ------------------------------------------------------------
 
     struct Variables_
     {
-      librandom::PoissonRandomDev poisson_dev_; //!< Random deviate generator
+      librandom::ExpRandomDev exp_dev_; //!< Random deviate generator
+
+      //! Centers of the receptive fields
+      std::vector<double> centers_;
+
+      //! Expected number of spikes per step of every receptive field
+      std::vector<double> lambdas_;
     };
 
     // Access functions for UniversalDataLogger -------------------------------
-    
-    //! Read out state vector elements, used by UniversalDataLogger
-    double get_rate_() const { return S_.rate_; }
 
     //! Read out state vector elements, used by UniversalDataLogger
     double get_current_() const { return S_.input_current_; }
@@ -207,10 +245,19 @@ namespace mynest
 
   };
 
-  
+
   inline
-  nest::port rbf_poisson_generator::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex syn_id, bool dummy_target)
+  nest::port rbf_poisson_generator::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex, bool dummy_target)
   {
+    // The dummy target tells whether the synapse model supports
+    // DSSpikeEvent, which carries the individual spike trains
+    if ( dummy_target )
+    {
+      nest::DSSpikeEvent e;
+      e.set_sender( *this );
+      return target.handles_test_event( e, receptor_type );
+    }
+
   	nest::SpikeEvent e;
     e.set_sender( *this );
     return target.handles_test_event( e, receptor_type );
@@ -245,14 +292,14 @@ namespace mynest
     Parameters_ ptmp = P_;  // temporary copy in case of errors
     ptmp.set(d);                       // throws if BadProperty
     State_      stmp = S_;  // temporary copy in case of errors
-    stmp.set(d, ptmp); 
-    
+    stmp.set(d, ptmp);
+
     // if we get here, temporaries contain consistent set of properties
     P_ = ptmp;
     S_ = stmp;
-    
+
   }
-  
+
 } // namespace
 
 #endif //rbf_poisson_generator_H
@@ -0,0 +1,194 @@
+/*
+ *  rk_integrator.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file rk_integrator.h
+ * Runge-Kutta integrators for small autonomous ODE systems whose right hand
+ * side is given as a functor, so that the compiler can inline it in the
+ * integration step.
+ */
+
+#ifndef RK_INTEGRATOR_H
+#define RK_INTEGRATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace mynest
+{
+
+/**
+ * Classical 4th order Runge-Kutta with a fixed step.
+ *
+ * The dynamics functor must provide
+ *   void operator()( const double y[], double dydt[] ) const
+ */
+template < std::size_t N >
+class RK4Integrator
+{
+public:
+  /**
+   * Advance y by h.
+   */
+  template < typename Dynamics >
+  static void step( const Dynamics& f, const double h, double y[ N ] )
+  {
+    double k1[ N ], k2[ N ], k3[ N ], k4[ N ], ytmp[ N ];
+
+    f( y, k1 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ] + 0.5 * h * k1[ i ];
+
+    f( ytmp, k2 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ] + 0.5 * h * k2[ i ];
+
+    f( ytmp, k3 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ] + h * k3[ i ];
+
+    f( ytmp, k4 );
+    for ( std::size_t i = 0; i < N; ++i )
+      y[ i ] += h / 6.0 * ( k1[ i ] + 2.0 * ( k2[ i ] + k3[ i ] ) + k4[ i ] );
+  }
+};
+
+/**
+ * Runge-Kutta-Fehlberg (4, 5) with adaptive step size.
+ *
+ * The coefficients and the step size control are those of gsl_odeiv_step_rkf45
+ * with gsl_odeiv_control_y_new( eps_abs, 0.0 ), so that the results match the
+ * GSL solver used by the neuron models up to rounding.
+ */
+template < std::size_t N >
+class RKF45Integrator
+{
+public:
+  explicit RKF45Integrator( double eps_abs = 1e-3 )
+    : eps_abs_( eps_abs )
+  {
+  }
+
+  /**
+   * Advance y from 0 to t1, starting with the step size h. On return, h holds
+   * the step size suggested for the next call, as gsl_odeiv_evolve_apply does.
+   */
+  template < typename Dynamics >
+  void evolve( const Dynamics& f, const double t1, double& h, double y[ N ] ) const
+  {
+    double t = 0.0;
+    while ( t < t1 )
+    {
+      double h0 = h;
+      bool final_step = false;
+      if ( h0 > t1 - t )
+      {
+        h0 = t1 - t;
+        final_step = true;
+      }
+
+      double y_new[ N ], y_err[ N ];
+      for ( ;; )
+      {
+        step_( f, h0, y, y_new, y_err );
+
+        // Standard GSL control with a_y = 1 and eps_rel = 0
+        double rmax = 0.0;
+        for ( std::size_t i = 0; i < N; ++i )
+          rmax = std::max( rmax, std::abs( y_err[ i ] ) / eps_abs_ );
+
+        // The step is retried with a smaller size, unless it would not
+        // change t anymore
+        if ( rmax > 1.1 )
+        {
+          const double r = std::max( 0.2, 0.9 / std::pow( rmax, 1.0 / order_ ) );
+          if ( t + h0 * r != t )
+          {
+            h0 *= r;
+            final_step = false;
+            continue;
+          }
+        }
+
+        t = final_step ? t1 : t + h0;
+        h = h0;
+        if ( rmax < 0.5 )
+          h *= std::min( 5.0, std::max( 1.0, 0.9 / std::pow( rmax, 1.0 / ( order_ + 1.0 ) ) ) );
+        break;
+      }
+
+      for ( std::size_t i = 0; i < N; ++i )
+        y[ i ] = y_new[ i ];
+    }
+  }
+
+private:
+  static constexpr double order_ = 5.0;
+
+  double eps_abs_;
+
+  // One Fehlberg step of size h from y. Writes the 5th order solution to
+  // y_new and the error estimate to y_err.
+  template < typename Dynamics >
+  static void step_( const Dynamics& f, const double h, const double y[ N ], double y_new[ N ], double y_err[ N ] )
+  {
+    double k1[ N ], k2[ N ], k3[ N ], k4[ N ], k5[ N ], k6[ N ], ytmp[ N ];
+
+    f( y, k1 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ] + h * ( 1.0 / 4.0 ) * k1[ i ];
+
+    f( ytmp, k2 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ] + h * ( 3.0 / 32.0 * k1[ i ] + 9.0 / 32.0 * k2[ i ] );
+
+    f( ytmp, k3 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ] + h * ( 1932.0 / 2197.0 * k1[ i ] - 7200.0 / 2197.0 * k2[ i ] + 7296.0 / 2197.0 * k3[ i ] );
+
+    f( ytmp, k4 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ]
+        + h * ( 439.0 / 216.0 * k1[ i ] - 8.0 * k2[ i ] + 3680.0 / 513.0 * k3[ i ] - 845.0 / 4104.0 * k4[ i ] );
+
+    f( ytmp, k5 );
+    for ( std::size_t i = 0; i < N; ++i )
+      ytmp[ i ] = y[ i ]
+        + h * ( -8.0 / 27.0 * k1[ i ] + 2.0 * k2[ i ] - 3544.0 / 2565.0 * k3[ i ] + 1859.0 / 4104.0 * k4[ i ]
+                - 11.0 / 40.0 * k5[ i ] );
+
+    f( ytmp, k6 );
+    for ( std::size_t i = 0; i < N; ++i )
+    {
+      y_new[ i ] = y[ i ]
+        + h * ( 16.0 / 135.0 * k1[ i ] + 6656.0 / 12825.0 * k3[ i ] + 28561.0 / 56430.0 * k4[ i ] - 9.0 / 50.0 * k5[ i ]
+                + 2.0 / 55.0 * k6[ i ] );
+      y_err[ i ] = h * ( 1.0 / 360.0 * k1[ i ] - 128.0 / 4275.0 * k3[ i ] - 2197.0 / 75240.0 * k4[ i ]
+                         + 1.0 / 50.0 * k5[ i ] + 2.0 / 55.0 * k6[ i ] );
+    }
+  }
+};
+
+} // of namespace mynest
+
+#endif // of #ifndef RK_INTEGRATOR_H
@@ -0,0 +1,278 @@
+/*
+ *  shm_current_generator.cpp
+ *
+ *  This file is based on the noise generator model distributed with NEST.
+ */
+
+#include "shm_current_generator.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+#include <algorithm>
+#include <time.h>
+
+
+namespace nest
+{
+  namespace names
+  {
+      const Name input_file("input_file");
+      const Name first_target("first_target");
+      const Name num_channels("num_channels");
+      const Name records_read("records_read");
+      const Name records_dropped("records_dropped");
+      const Name latency_mean("latency_mean");
+      const Name latency_max("latency_max");
+  }
+}
+
+namespace
+{
+  const uint32_t SHM_INPUT_MAGIC = 0x49534243;
+  const uint32_t SHM_INPUT_VERSION = 1;
+
+  // Time of the monotonic clock in s, the same clock as time.monotonic()
+  double monotonic_time()
+  {
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+  }
+}
+
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::shm_current_generator::Parameters_::Parameters_()
+   : input_file_()
+   , first_target_( 0 )
+{
+}
+
+mynest::shm_current_generator::State_::State_()
+  : records_read_( 0 )
+  , records_dropped_( 0 )
+  , latency_sum_( 0.0 )
+  , latency_max_( 0.0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extractions and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void mynest::shm_current_generator::Parameters_::get(DictionaryDatum &d) const
+{
+  def< std::string >( d, nest::names::input_file, input_file_ );
+  def< long >( d, nest::names::first_target, first_target_ );
+}
+
+void mynest::shm_current_generator::Parameters_::set(const DictionaryDatum& d)
+{
+  updateValue< std::string >( d, nest::names::input_file, input_file_ );
+  updateValue< long >( d, nest::names::first_target, first_target_ );
+  if ( first_target_ < 0 )
+  {
+    throw nest::BadProperty( "The first_target parameter cannot be negative." );
+  }
+}
+
+void mynest::shm_current_generator::State_::get(DictionaryDatum &d) const
+{
+  def< long >( d, nest::names::records_read, records_read_ );
+  def< long >( d, nest::names::records_dropped, records_dropped_ );
+  def< double >( d, nest::names::latency_mean, records_read_ > 0 ? latency_sum_ / records_read_ : 0.0 );
+  def< double >( d, nest::names::latency_max, latency_max_ );
+}
+
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node, and destructor
+ * ---------------------------------------------------------------- */
+
+mynest::shm_current_generator::shm_current_generator()
+  : DeviceNode()
+  , P_()
+  , S_()
+{
+  V_.header_ = 0;
+  V_.records_ = 0;
+}
+
+mynest::shm_current_generator::shm_current_generator(const shm_current_generator& n)
+  : DeviceNode( n )
+  , P_( n.P_ )
+  , S_( n.S_ )
+{
+  // Every copy maps the buffer itself in calibrate()
+  V_.header_ = 0;
+  V_.records_ = 0;
+}
+
+mynest::shm_current_generator::~shm_current_generator()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void mynest::shm_current_generator::init_state_(const Node& proto)
+{
+  const shm_current_generator& pr = downcast< shm_current_generator >( proto );
+
+  S_ = pr.S_;
+}
+
+void mynest::shm_current_generator::init_buffers_()
+{
+  B_.values_.clear();
+  B_.read_count_ = 0;
+}
+
+void mynest::shm_current_generator::calibrate()
+{
+  if ( P_.input_file_.empty() )
+  {
+    V_.file_.close();
+    V_.header_ = 0;
+    V_.records_ = 0;
+    B_.values_.clear();
+    return;
+  }
+
+  if ( !V_.file_.is_open() || V_.file_.path() != P_.input_file_ )
+  {
+    map_buffer_();
+  }
+
+  // The currents are zero until the first record is read
+  if ( B_.values_.size() != V_.header_->num_channels )
+  {
+    B_.values_.assign( V_.header_->num_channels, 0.0 );
+    B_.read_count_ = 0;
+  }
+}
+
+void mynest::shm_current_generator::map_buffer_()
+{
+  V_.header_ = 0;
+  V_.records_ = 0;
+  V_.file_.open( P_.input_file_ );
+
+  if ( V_.file_.size() < sizeof( ShmInputHeader ) )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " is not a shared-memory input buffer." ).c_str() );
+  }
+
+  const ShmInputHeader* header = reinterpret_cast< const ShmInputHeader* >( V_.file_.data() );
+  if ( header->magic != SHM_INPUT_MAGIC || header->version != SHM_INPUT_VERSION )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " is not a shared-memory input buffer." ).c_str() );
+  }
+  if ( header->num_slots < 2 || header->num_channels < 1 )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " must have at least 2 slots and 1 channel." ).c_str() );
+  }
+
+  const size_t record_size = ( header->num_channels + 1 ) * sizeof( double );
+  if ( V_.file_.size() < sizeof( ShmInputHeader ) + header->num_slots * record_size )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " is smaller than its records." ).c_str() );
+  }
+
+  V_.header_ = header;
+  V_.records_ = reinterpret_cast< const double* >( V_.file_.data() + sizeof( ShmInputHeader ) );
+}
+
+/* ----------------------------------------------------------------
+ * Update and spike handling functions
+ * ---------------------------------------------------------------- */
+
+void mynest::shm_current_generator::read_last_record_()
+{
+  uint64_t count = __atomic_load_n( &V_.header_->write_count, __ATOMIC_ACQUIRE );
+  if ( count == B_.read_count_ )
+  {
+    return;
+  }
+  if ( count < B_.read_count_ )
+  {
+    // The writer started again from the first record
+    B_.read_count_ = 0;
+  }
+
+  const size_t n_channels = B_.values_.size();
+  const uint64_t n_slots = V_.header_->num_slots;
+  double stamp = 0.0;
+
+  while ( true )
+  {
+    const double* record = V_.records_ + ( ( count - 1 ) % n_slots ) * ( n_channels + 1 );
+    stamp = record[ 0 ];
+    std::copy( record + 1, record + 1 + n_channels, B_.values_.begin() );
+
+    // The record was complete if the writer did not come back to its slot
+    // while it was copied
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    const uint64_t new_count = __atomic_load_n( &V_.header_->write_count, __ATOMIC_ACQUIRE );
+    if ( new_count - count < n_slots - 1 )
+    {
+      break;
+    }
+    count = new_count;
+  }
+
+  S_.records_dropped_ += count - 1 - B_.read_count_;
+  B_.read_count_ = count;
+  ++S_.records_read_;
+
+  const double latency = ( monotonic_time() - stamp ) * 1e3;
+  S_.latency_sum_ += latency;
+  S_.latency_max_ = std::max( S_.latency_max_, latency );
+}
+
+void mynest::shm_current_generator::update(nest::Time const &, const long from, const long to)
+{
+  assert(
+    to >= 0 && ( nest::delay ) from < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  if ( V_.header_ == 0 )
+  {
+    return;
+  }
+
+  // The buffer is read once per call, the records are published at the
+  // pace of the external process and not of the simulation steps
+  read_last_record_();
+
+  for ( long lag = from; lag < to; ++lag )
+  {
+    // The current of every target is set in event_hook
+    nest::DSCurrentEvent e;
+    nest::kernel().event_delivery_manager.send( *this, e, lag );
+  }
+}
+
+void mynest::shm_current_generator::event_hook(nest::DSCurrentEvent& e)
+{
+  const long channel = static_cast< long >( e.get_receiver().get_gid() ) - P_.first_target_;
+
+  if ( channel >= 0 && channel < static_cast< long >( B_.values_.size() ) )
+  {
+    e.set_current( B_.values_[ channel ] );
+    e.get_receiver().handle( e );
+  }
+}
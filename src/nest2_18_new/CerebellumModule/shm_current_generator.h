@@ -0,0 +1,270 @@
+/*
+ *  shm_current_generator.h
+ *
+ *  This file is based on the noise generator model distributed with NEST.
+ */
+
+#ifndef SHM_CURRENT_GENERATOR_H
+#define SHM_CURRENT_GENERATOR_H
+
+// Includes from nestkernel:
+#include "connection.h"
+#include "event.h"
+#include "nest_types.h"
+#include "device_node.h"
+
+#include "mapped_file.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* BeginDocumentation
+Name: shm_current_generator - inject currents read from a shared-memory ring
+                              buffer written by another process.
+Description:
+  The shm_current_generator takes the input currents of a population of
+  nodes, e.g. the cd_poisson_generators that encode the state of a robot arm,
+  from a ring buffer in a memory-mapped file written by an external process.
+  At the beginning of every call to update (every min_delay), it takes the
+  last record published in the buffer, and injects its values as currents
+  until the next record arrives. This replaces the calls to SetStatus from
+  Python between short simulations in a closed loop: the simulation can run
+  in a single call to Simulate while the external process publishes records.
+
+  The target with id g receives the value of the channel g - first_target.
+  Targets whose channel is not in the buffer receive no current.
+
+  The buffer is a file, usually in /dev/shm, with a header of 64 bytes
+
+    uint32 magic        - 0x49534243 ("CBSI" in little endian)
+    uint32 version      - 1
+    uint32 num_channels - Number of values per record
+    uint32 num_slots    - Number of records in the ring (at least 2)
+    uint64 write_count  - Number of records published so far
+    (40 bytes of padding)
+
+  followed by num_slots records of num_channels + 1 doubles: the time of the
+  record in seconds, taken from the monotonic clock of the system (as
+  time.monotonic() in Python), and the values. The writer stores the
+  record write_count in the slot write_count % num_slots, and increments
+  write_count after the record is complete.
+
+Parameters:
+   The following parameters appear in the element's status dictionary:
+
+   input_file      string - Path of the shared-memory buffer
+   first_target    int    - Id of the target that receives the channel 0
+   num_channels    int    - Number of channels of the buffer (read only)
+   records_read    int    - Number of records applied (read only)
+   records_dropped int    - Number of records replaced by a newer one before
+                            they could be applied (read only)
+   latency_mean    double - Mean time in ms from the publication of a record
+                            to its injection (read only)
+   latency_max     double - Maximum of that time in ms (read only)
+
+Sends: CurrentEvent
+
+Remarks:
+   The buffer is mapped when the simulation starts, so the writer must have
+   created it before Simulate is called.
+
+   The latency is measured in wall-clock time, when the values are sent. The
+   spikes driven by the new currents are emitted after the delay of the
+   connections, at most min_delay later in simulated time.
+
+   The device has a copy in every thread, and every copy reads the buffer
+   independently. With several threads, the targets on different threads
+   may switch to a new record in different calls to update.
+
+   As with noise_generator, the currents can only be sent through synapse
+   models that support DSCurrentEvent, such as static_synapse.
+
+SeeAlso: cd_poisson_generator, dc_generator, noise_generator
+*/
+
+// Define name constants for state variables and parameters
+namespace nest
+{
+	namespace names
+	{
+      extern const Name input_file;
+      extern const Name first_target;
+      extern const Name num_channels;
+      extern const Name records_read;
+      extern const Name records_dropped;
+      extern const Name latency_mean;
+      extern const Name latency_max;
+    }
+}
+
+namespace mynest
+{
+  /**
+   * Header of the shared-memory ring buffer.
+   */
+  struct ShmInputHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_channels;
+    uint32_t num_slots;
+    uint64_t write_count;
+    uint64_t padding[ 5 ];
+  };
+
+  class shm_current_generator : public nest::DeviceNode
+  {
+
+  public:
+
+    shm_current_generator();
+    shm_current_generator(const shm_current_generator&);
+    ~shm_current_generator();
+
+    /**
+     * Import sets of overloaded virtual functions.
+     * We need to explicitly include sets of overloaded
+     * virtual functions into the current scope.
+     * According to the SUN C++ FAQ, this is the correct
+     * way of doing things, although all other compilers
+     * happily live without.
+     */
+
+    using nest::Node::event_hook;
+
+    nest::port send_test_event(nest::Node&, nest::rport, nest::synindex, bool);
+
+    void get_status(DictionaryDatum &) const;
+    void set_status(const DictionaryDatum &);
+
+  private:
+    void init_state_(const Node& proto);
+    void init_buffers_();
+    void calibrate();
+
+    void update(nest::Time const &, const long, const long);
+
+    /**
+     * Send the current of the channel of a single target.
+     */
+    void event_hook(nest::DSCurrentEvent&);
+
+    // Map the buffer of input_file and check its header
+    void map_buffer_();
+
+    // Copy the last record of the buffer, if a new one was published
+    void read_last_record_();
+
+    // END Boilerplate function declarations ----------------------------
+
+  private:
+
+    /**
+      * Store independent parameters of the model.
+      */
+    struct Parameters_{
+      //! Path of the shared-memory buffer
+      std::string input_file_;
+
+      //! Id of the target of the channel 0
+      long first_target_;
+
+      Parameters_(); //!< Sets default parameter values
+
+      void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+      void set( const DictionaryDatum& ); //!< Set values from dicitonary
+    };
+
+  public:
+    // ----------------------------------------------------------------
+
+    /**
+     * State variables of the model.
+     */
+    struct State_ {
+
+      long records_read_;
+      long records_dropped_;
+
+      double latency_sum_; //!< in ms
+      double latency_max_; //!< in ms
+
+      State_();  //!< Default initialization
+
+      void get(DictionaryDatum&) const;
+    };
+
+    // ----------------------------------------------------------------
+
+  private:
+
+    /**
+     * Buffers of the model.
+     */
+    struct Buffers_ {
+      //! Values of the last record read
+      std::vector<double> values_;
+
+      //! write_count of the buffer when the last record was read
+      uint64_t read_count_;
+    };
+
+  // ------------------------------------------------------------
+
+    struct Variables_
+    {
+      MappedFile file_; //!< Mapping of the shared-memory buffer
+
+      const ShmInputHeader* header_; //!< Header of the buffer
+      const double* records_;        //!< First record of the buffer
+    };
+
+  // ------------------------------------------------------------
+
+    Parameters_ P_;
+    Variables_ V_;
+    State_ S_;
+    Buffers_ B_;
+
+  };
+
+
+  inline
+  nest::port shm_current_generator::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex, bool dummy_target)
+  {
+    // The dummy target tells whether the synapse model supports
+    // DSCurrentEvent, which carries the current of every target
+    if ( dummy_target )
+    {
+      nest::DSCurrentEvent e;
+      e.set_sender( *this );
+      return target.handles_test_event( e, receptor_type );
+    }
+
+    nest::CurrentEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+
+  inline
+  void shm_current_generator::get_status(DictionaryDatum &d) const
+  {
+    P_.get(d);
+    S_.get(d);
+    def< long >( d, nest::names::num_channels, B_.values_.size() );
+  }
+
+  inline
+  void shm_current_generator::set_status(const DictionaryDatum &d)
+  {
+    Parameters_ ptmp = P_;  // temporary copy in case of errors
+    ptmp.set(d);                       // throws if BadProperty
+
+    // if we get here, temporaries contain consistent set of properties
+    P_ = ptmp;
+  }
+
+} // namespace
+
+#endif //SHM_CURRENT_GENERATOR_H
@@ -0,0 +1,172 @@
+/*
+ *  spike_file_neuron.cpp
+ *
+ *  This file is based on the spike generator and parrot neuron models
+ *  distributed with NEST.
+ */
+
+#include "spike_file_neuron.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "integerdatum.h"
+
+#include <cmath>
+
+
+namespace nest
+{
+  namespace names
+  {
+      const Name first_neuron("first_neuron");
+      const Name num_fibers("num_fibers");
+  }
+}
+
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::spike_file_neuron::Parameters_::Parameters_()
+   : input_file_()
+   , first_neuron_( 0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extractions and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void mynest::spike_file_neuron::Parameters_::get(DictionaryDatum &d) const
+{
+  def< std::string >( d, nest::names::input_file, input_file_ );
+  def< long >( d, nest::names::first_neuron, first_neuron_ );
+}
+
+void mynest::spike_file_neuron::Parameters_::set(const DictionaryDatum& d)
+{
+  updateValue< std::string >( d, nest::names::input_file, input_file_ );
+  updateValue< long >( d, nest::names::first_neuron, first_neuron_ );
+  if ( first_neuron_ < 0 )
+  {
+    throw nest::BadProperty( "The first_neuron parameter cannot be negative." );
+  }
+}
+
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node, and destructor
+ * ---------------------------------------------------------------- */
+
+mynest::spike_file_neuron::spike_file_neuron()
+  : Archiving_Node()
+  , P_()
+{
+  V_.fiber_ = -1;
+}
+
+mynest::spike_file_neuron::spike_file_neuron(const spike_file_neuron& n)
+  : Archiving_Node( n )
+  , P_( n.P_ )
+{
+  V_.fiber_ = -1;
+}
+
+mynest::spike_file_neuron::~spike_file_neuron()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void mynest::spike_file_neuron::init_state_(const Node&)
+{
+}
+
+void mynest::spike_file_neuron::init_buffers_()
+{
+  nest::Archiving_Node::clear_history();
+}
+
+void mynest::spike_file_neuron::calibrate()
+{
+  V_.fiber_ = -1;
+
+  if ( P_.input_file_.empty() )
+  {
+    V_.reader_.reset();
+    return;
+  }
+
+  if ( !V_.reader_ || V_.reader_->path() != P_.input_file_ )
+  {
+    V_.reader_ = SpikeFileReader::shared( P_.input_file_ );
+  }
+
+  const double resolution = nest::Time::get_resolution().get_ms();
+  if ( std::abs( V_.reader_->resolution() - resolution ) > 1e-6 * resolution )
+  {
+    throw nest::KernelException( ( P_.input_file_ + " was written for another resolution." ).c_str() );
+  }
+
+  const long fiber = static_cast< long >( get_gid() ) - P_.first_neuron_;
+  if ( fiber >= 0 && fiber < static_cast< long >( V_.reader_->num_fibers() ) )
+  {
+    V_.fiber_ = fiber;
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and spike handling functions
+ * ---------------------------------------------------------------- */
+
+void mynest::spike_file_neuron::update(nest::Time const & T, const long from, const long to)
+{
+  assert(
+    to >= 0 && ( nest::delay ) from < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  if ( !V_.reader_ )
+  {
+    return;
+  }
+
+  // The spikes emitted in the step T+lag have time stamp T+lag+1
+  V_.reader_->prepare( T.get_steps() + from + 1, T.get_steps() + to + 1 );
+
+  if ( V_.fiber_ < 0 )
+  {
+    return;
+  }
+
+  const SpikeFileReader::Spike* spike;
+  const SpikeFileReader::Spike* end;
+  V_.reader_->spikes( V_.fiber_, spike, end );
+
+  while ( spike != end )
+  {
+    // Repeated spikes in a step are sent with multiplicity
+    const long step = spike->step;
+    long n_spikes = 0;
+    for ( ; spike != end && spike->step == step; ++spike )
+    {
+      ++n_spikes;
+    }
+
+    nest::SpikeEvent se;
+    se.set_multiplicity( n_spikes );
+    nest::kernel().event_delivery_manager.send( *this, se, step - T.get_steps() - 1 );
+
+    // set the spike times, respecting the multiplicity
+    for ( long i = 0; i < n_spikes; ++i )
+      set_spiketime( nest::Time::step( step ) );
+  }
+}
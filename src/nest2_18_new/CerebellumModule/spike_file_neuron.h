@@ -0,0 +1,184 @@
+/*
+ *  spike_file_neuron.h
+ *
+ *  This file is based on the spike generator and parrot neuron models
+ *  distributed with NEST.
+ */
+
+#ifndef SPIKE_FILE_NEURON_H
+#define SPIKE_FILE_NEURON_H
+
+// Includes from nestkernel:
+#include "archiving_node.h"
+#include "connection.h"
+#include "event.h"
+#include "nest_types.h"
+
+#include "spike_file_reader.h"
+
+#include <memory>
+#include <string>
+
+/* BeginDocumentation
+Name: spike_file_neuron - Neuron that plays a fiber of a binary spike file.
+Description:
+  The spike_file_neuron emits the spikes of one fiber of a binary spike file,
+  as the simulation reaches them. A population of spike_file_neurons replaces
+  the pairs of spike_generator and parrot_neuron that feed recorded or
+  precomputed spike trains into plastic synapses, without setting the
+  spike_times of every generator from Python.
+
+  The neuron with id g plays the fiber g - first_neuron, so a whole
+  population is set up with a single call:
+
+    fibers = nest.Create('spike_file_neuron', n, {'input_file': path})
+    nest.SetStatus(fibers, {'first_neuron': fibers[0]})
+
+  The file contains the spikes of all the fibers sorted by time step, with
+  the steps and fibers delta-encoded as variable-length integers (see
+  spike_file_reader.h). All the neurons that play the same file share a
+  single reader, which decodes only the spikes of the current slice, so the
+  memory used does not grow with the length of the file or the number of
+  fibers.
+
+Parameters:
+   The following parameters appear in the element's status dictionary:
+
+   input_file   string - Path of the spike file
+   first_neuron int    - Id of the neuron that plays the fiber 0
+   num_fibers   int    - Number of fibers of the file (read only)
+
+Sends: SpikeEvent
+
+Remarks:
+   A spike in the step s of the file is emitted with time stamp s times the
+   resolution, which must be the resolution of the file. Spikes at step 0
+   cannot be emitted and are ignored, as in spike_generator.
+
+   Several spikes of a fiber in the same step are sent as a single spike with
+   multiplicity, and all of them are stored in the spike history, as the
+   parrot_neuron does. Neurons whose fiber is not in the file do not fire.
+
+SeeAlso: spike_generator, parrot_neuron, cd_poisson_neuron
+*/
+
+// Define name constants for state variables and parameters
+namespace nest
+{
+	namespace names
+	{
+      extern const Name input_file;
+      extern const Name first_neuron;
+      extern const Name num_fibers;
+    }
+}
+
+namespace mynest
+{
+  class spike_file_neuron : public nest::Archiving_Node
+  {
+
+  public:
+
+    spike_file_neuron();
+    spike_file_neuron(const spike_file_neuron&);
+    ~spike_file_neuron();
+
+
+    /**
+     * Import sets of overloaded virtual functions.
+     * We need to explicitly include sets of overloaded
+     * virtual functions into the current scope.
+     * According to the SUN C++ FAQ, this is the correct
+     * way of doing things, although all other compilers
+     * happily live without.
+     */
+
+    using nest::Node::handles_test_event;
+    using nest::Node::handle;
+
+    nest::port send_test_event(nest::Node&, nest::rport, nest::synindex, bool);
+
+    void get_status(DictionaryDatum &) const;
+    void set_status(const DictionaryDatum &);
+
+  private:
+    void init_state_(const Node& proto);
+    void init_buffers_();
+    void calibrate();
+
+    void update(nest::Time const &, const long, const long);
+
+    // END Boilerplate function declarations ----------------------------
+
+  private:
+
+    /**
+      * Store independent parameters of the model.
+      */
+    struct Parameters_{
+      //! Path of the spike file
+      std::string input_file_;
+
+      //! Id of the neuron of the fiber 0
+      long first_neuron_;
+
+      Parameters_(); //!< Sets default parameter values
+
+      void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+      void set( const DictionaryDatum& ); //!< Set values from dicitonary
+    };
+
+  // ------------------------------------------------------------
+
+    struct Variables_
+    {
+      //! Reader of the spike file, shared with the other neurons
+      std::shared_ptr< SpikeFileReader > reader_;
+
+      //! Fiber played by this neuron, or -1 if it is not in the file
+      long fiber_;
+    };
+
+  // ------------------------------------------------------------
+
+    Parameters_ P_;
+    Variables_ V_;
+
+  };
+
+
+  inline
+  nest::port spike_file_neuron::send_test_event(nest::Node& target, nest::rport receptor_type, nest::synindex, bool)
+  {
+  	nest::SpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+
+  inline
+  void spike_file_neuron::get_status(DictionaryDatum &d) const
+  {
+    P_.get(d);
+    def< long >( d, nest::names::num_fibers, V_.reader_ ? V_.reader_->num_fibers() : 0 );
+    nest::Archiving_Node::get_status(d);
+  }
+
+  inline
+  void spike_file_neuron::set_status(const DictionaryDatum &d)
+  {
+    Parameters_ ptmp = P_;  // temporary copy in case of errors
+    ptmp.set(d);                       // throws if BadProperty
+
+    // We now know that ptmp is consistent. We do not write it back
+    // to P_ before we are also sure that the properties to be set
+    // in the parent class are internally consistent.
+    nest::Archiving_Node::set_status(d);
+
+    // if we get here, temporaries contain consistent set of properties
+    P_ = ptmp;
+  }
+
+} // namespace
+
+#endif //SPIKE_FILE_NEURON_H
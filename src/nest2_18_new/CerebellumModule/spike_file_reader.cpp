@@ -0,0 +1,236 @@
+/*
+ *  spike_file_reader.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spike_file_reader.h"
+
+// Includes from nestkernel:
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  const uint32_t SPIKE_FILE_MAGIC = 0x46534243;
+  const uint32_t SPIKE_FILE_VERSION = 1;
+  const size_t SPIKE_FILE_HEADER_SIZE = 64;
+
+  // The decoded pages are released in chunks of this size
+  const size_t RELEASE_CHUNK = 1 << 20;
+
+  bool fiber_less( const mynest::SpikeFileReader::Spike& a, const mynest::SpikeFileReader::Spike& b )
+  {
+    return a.fiber < b.fiber;
+  }
+}
+
+std::map< std::string, std::weak_ptr< mynest::SpikeFileReader > > mynest::SpikeFileReader::shared_readers_;
+
+mynest::SpikeFileReader::SpikeFileReader( const std::string& path )
+  : num_fibers_( 0 )
+  , resolution_( 0.0 )
+  , pos_( 0 )
+  , released_( 0 )
+  , has_next_( false )
+  , window_first_( -1 )
+  , window_last_( -1 )
+{
+  file_.open( path );
+
+  const char* data = file_.data();
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  if ( file_.size() >= SPIKE_FILE_HEADER_SIZE )
+  {
+    std::memcpy( &magic, data, sizeof( magic ) );
+    std::memcpy( &version, data + 4, sizeof( version ) );
+  }
+  if ( magic != SPIKE_FILE_MAGIC || version != SPIKE_FILE_VERSION )
+  {
+    throw nest::KernelException( ( path + " is not a spike file." ).c_str() );
+  }
+
+  std::memcpy( &num_fibers_, data + 8, sizeof( num_fibers_ ) );
+  std::memcpy( &resolution_, data + 16, sizeof( resolution_ ) );
+
+  file_.advise_sequential();
+  rewind_();
+}
+
+std::shared_ptr< mynest::SpikeFileReader >
+mynest::SpikeFileReader::shared( const std::string& path )
+{
+  std::shared_ptr< SpikeFileReader > reader;
+  std::string error;
+
+  // The neurons are calibrated in parallel by all the threads, and
+  // exceptions cannot leave the critical section
+#pragma omp critical( spike_file_reader )
+  {
+    reader = shared_readers_[ path ].lock();
+    if ( !reader )
+    {
+      try
+      {
+        reader.reset( new SpikeFileReader( path ) );
+        shared_readers_[ path ] = reader;
+      }
+      catch ( nest::KernelException& e )
+      {
+        shared_readers_.erase( path );
+        error = e.what();
+      }
+    }
+  }
+
+  if ( !reader )
+  {
+    throw nest::KernelException( error.c_str() );
+  }
+
+  return reader;
+}
+
+void
+mynest::SpikeFileReader::rewind_()
+{
+  pos_ = SPIKE_FILE_HEADER_SIZE;
+  released_ = 0;
+
+  // The first spike is decoded from step 0 and fiber 0
+  next_.step = 0;
+  next_.fiber = 0;
+  has_next_ = true;
+  decode_next_();
+}
+
+bool
+mynest::SpikeFileReader::read_varint_( uint64_t& value )
+{
+  const unsigned char* data = reinterpret_cast< const unsigned char* >( file_.data() );
+  value = 0;
+
+  for ( unsigned int shift = 0; shift < 64; shift += 7 )
+  {
+    if ( pos_ >= file_.size() )
+    {
+      return false;
+    }
+
+    const unsigned char byte = data[ pos_++ ];
+    value |= static_cast< uint64_t >( byte & 0x7f ) << shift;
+    if ( ( byte & 0x80 ) == 0 )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+mynest::SpikeFileReader::decode_next_()
+{
+  uint64_t delta_step;
+  uint64_t fiber;
+
+  // A truncated spike at the end of the file is ignored
+  if ( !read_varint_( delta_step ) || !read_varint_( fiber ) )
+  {
+    has_next_ = false;
+    return;
+  }
+
+  if ( delta_step > 0 )
+  {
+    next_.step += delta_step;
+    next_.fiber = fiber;
+  }
+  else
+  {
+    next_.fiber += fiber;
+  }
+}
+
+void
+mynest::SpikeFileReader::prepare( long first_step, long last_step )
+{
+  // The window only changes between the updates of two slices, so it is
+  // checked without locking first
+  if ( __atomic_load_n( &window_first_, __ATOMIC_ACQUIRE ) == first_step && window_last_ == last_step )
+  {
+    return;
+  }
+
+#pragma omp critical( spike_file_reader )
+  {
+    if ( window_first_ != first_step || window_last_ != last_step )
+    {
+      fill_window_( first_step, last_step );
+    }
+  }
+}
+
+void
+mynest::SpikeFileReader::fill_window_( long first_step, long last_step )
+{
+  if ( first_step < window_last_ )
+  {
+    rewind_();
+  }
+
+  window_.clear();
+  while ( has_next_ && next_.step < last_step )
+  {
+    if ( next_.step >= first_step )
+    {
+      window_.push_back( next_ );
+    }
+    decode_next_();
+  }
+
+  std::sort( window_.begin(), window_.end() );
+
+  // The bytes before pos_ are not needed any more
+  if ( pos_ - released_ >= RELEASE_CHUNK )
+  {
+    file_.release( released_, pos_ - released_ );
+    released_ = pos_;
+  }
+
+  window_last_ = last_step;
+  __atomic_store_n( &window_first_, first_step, __ATOMIC_RELEASE );
+}
+
+void
+mynest::SpikeFileReader::spikes( uint32_t fiber, const Spike*& begin, const Spike*& end ) const
+{
+  Spike key;
+  key.step = 0;
+  key.fiber = fiber;
+
+  const Spike* first = window_.data();
+  const Spike* last = first + window_.size();
+  std::pair< const Spike*, const Spike* > range = std::equal_range( first, last, key, fiber_less );
+  begin = range.first;
+  end = range.second;
+}
@@ -0,0 +1,155 @@
+/*
+ *  spike_file_reader.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file spike_file_reader.h
+ * Streaming decoder of the binary spike files played by spike_file_neuron.
+ *
+ * The file has a header of 64 bytes
+ *
+ *   uint32 magic      - 0x46534243 ("CBSF" in little endian)
+ *   uint32 version    - 1
+ *   uint32 num_fibers - Number of fibers
+ *   uint32 padding
+ *   double resolution - Duration of a step in ms
+ *   uint64 num_spikes - Number of spikes in the file
+ *   (32 bytes of padding)
+ *
+ * followed by the spikes sorted by step and fiber. Every spike is a pair of
+ * unsigned LEB128 integers: the number of steps since the previous spike,
+ * and the fiber, as the difference with the fiber of the previous spike if
+ * both are in the same step. A spike repeated in the same step and fiber
+ * has multiplicity.
+ */
+
+#ifndef SPIKE_FILE_READER_H
+#define SPIKE_FILE_READER_H
+
+#include "mapped_file.h"
+
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace mynest
+{
+
+class SpikeFileReader
+{
+public:
+  struct Spike
+  {
+    long step;
+    uint32_t fiber;
+
+    //! Spikes are ordered by fiber, then by step
+    bool operator<( const Spike& s ) const
+    {
+      return fiber < s.fiber || ( fiber == s.fiber && step < s.step );
+    }
+  };
+
+  /**
+   * Map the file at path and check its header.
+   * Throws nest::KernelException if it is not a spike file.
+   */
+  explicit SpikeFileReader( const std::string& path );
+
+  /**
+   * Reader of the file at path shared by all the neurons that play it, so
+   * that the file is decoded only once.
+   */
+  static std::shared_ptr< SpikeFileReader > shared( const std::string& path );
+
+  /**
+   * Decode the spikes in the steps [first_step, last_step), if they are not
+   * decoded yet. Every neuron calls it in update, and only the first call of
+   * every slice decodes the file. Going back in time reads the file again
+   * from the start.
+   */
+  void prepare( long first_step, long last_step );
+
+  /**
+   * Spikes of a fiber in the steps given to the last call to prepare,
+   * sorted by step.
+   */
+  void spikes( uint32_t fiber, const Spike*& begin, const Spike*& end ) const;
+
+  size_t
+  num_fibers() const
+  {
+    return num_fibers_;
+  }
+
+  double
+  resolution() const
+  {
+    return resolution_;
+  }
+
+  const std::string&
+  path() const
+  {
+    return file_.path();
+  }
+
+private:
+  SpikeFileReader( const SpikeFileReader& );
+  SpikeFileReader& operator=( const SpikeFileReader& );
+
+  // Go back to the first spike of the file
+  void rewind_();
+
+  // Decode the spike after next_ into next_, or clear has_next_ at the end
+  void decode_next_();
+
+  // Decode an unsigned LEB128 integer at pos_
+  bool read_varint_( uint64_t& value );
+
+  void fill_window_( long first_step, long last_step );
+
+  MappedFile file_;
+
+  uint32_t num_fibers_;
+  double resolution_;
+
+  size_t pos_;      //!< Offset of the first byte not decoded yet
+  size_t released_; //!< Bytes before this offset have been released
+
+  Spike next_;    //!< First spike not in the window
+  bool has_next_; //!< False at the end of the file
+
+  long window_first_; //!< First step of the window
+  long window_last_;  //!< Step after the last step of the window
+
+  //! Spikes of the window, by fiber
+  std::vector< Spike > window_;
+
+  //! Shared readers by path
+  static std::map< std::string, std::weak_ptr< SpikeFileReader > > shared_readers_;
+};
+
+} // of namespace mynest
+
+#endif // of #ifndef SPIKE_FILE_READER_H
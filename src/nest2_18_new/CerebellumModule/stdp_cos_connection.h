@@ -25,6 +25,16 @@
       Wmax      double - Maximal synaptic weight
       exponent  unsigned int - Exponent of the sin function (integer between 1 and 20). The lower the exponent the wider the kernel function.
       tau_cos   double - Time constant of the learning rule (in ms)
+      plastic   bool   - If false the weight is frozen and the synapse behaves as a static synapse (default true)
+
+   Freezing a connection with SetStatus stops its target from keeping the
+   history for it right away. Connections created after freezing the model
+   with SetDefaults are never registered in the history of their targets.
+
+   The model stdp_cos_synapse_sp stores the weight, the state variables and the
+   parameters in single precision, since the look-up tables are computed in
+   single precision anyway. The spike times stay in double precision, so on
+   64-bit systems the synapse takes 96 instead of 136 bytes.
 
   References:
    [1] Luque, N. R., Garrido, J. A., Naveros, F., Carrillo, R. R., D'Angelo, E., & Ros, E. (2016).
@@ -44,7 +54,9 @@
 #include "common_synapse_properties.h"
 
 #include "connection.h"
+#include "kernel_manager.h"
 #include "archiving_node_cos.h"
+#include "synapse_model_lookup.h"
 
 #include "ExponentialTable.h"
 #include "TrigonometricTable.h"
@@ -56,8 +68,10 @@ namespace mynest
 
 /**
  * Class representing an STDPCosConnection.
+ * realT is the type used to store the weight, the state variables and the
+ * parameters of the synapse (float for stdp_cos_synapse_sp).
  */
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT = double >
 class STDPCosConnection : public nest::Connection< targetidentifierT >
 {
 
@@ -134,7 +148,12 @@ public:
     ConnTestDummyNode dummy_target;
     ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
 
-    ((Archiving_Node_Cos *) (&t))->register_stdp_connection_cos( t_lastspike - get_delay() );
+    // Frozen synapses do not read the history of the target
+    if ( this->plastic_ )
+    {
+      ((Archiving_Node_Cos *) (&t))->register_stdp_connection_cos( t_lastspike - get_delay() );
+    }
+    this->registered_ = this->plastic_;
   }
 
   void
@@ -145,47 +164,55 @@ public:
 
 private:
   // data members of each connection
-  double weight_;
+  realT weight_;
 
-  double last_spike_weight_change_;
+  realT last_spike_weight_change_;
 
   // Cos^2 accumulation variable
-  double cos2_;
+  realT cos2_;
 
   // Sin^2 accumulation variable
-  double sin2_;
+  realT sin2_;
 
   // Cos*Sin accumulation variable
-  double cossin_;
+  realT cossin_;
 
   double t_last_update_;
 
   // This vars could be common, but state_vars has to be resized according to Exponent.
   // Remaining vars depends on Exponent too.
-  double exponent_;
-  double inv_tau_;
+  realT exponent_;
+  realT inv_tau_;
 
   // This vars could be also common, but this optimization might be performed as a future development.
-  double A_plus_;
-  double A_minus_;
-  double Wmin_;
-  double Wmax_;
+  realT A_plus_;
+  realT A_minus_;
+  realT Wmin_;
+  realT Wmax_;
 
   double t_lastspike;
 
-  void evolve_cos_values( double ElapsedTime,
-                          double oldcos2, double oldsin2, double oldcossin,
-                          double& cos2, double& sin2, double& cossin);
+  // Whether the weight is updated by the learning rule
+  bool plastic_;
 
-  double check_weight_boundaries(double weight);
+  // Whether the synapse is registered in the history of the target. It is
+  // cleared by set_status when the plasticity is frozen, and set again by the
+  // next presynaptic spike when it is enabled.
+  bool registered_;
+
+  void evolve_cos_values( realT ElapsedTime,
+                          realT oldcos2, realT oldsin2, realT oldcossin,
+                          realT& cos2, realT& sin2, realT& cossin);
+
+  realT check_weight_boundaries(realT weight);
 };
 
 //
 // Implementation of class STDPSinConnection.
 //
 
-template < typename targetidentifierT >
-STDPCosConnection< targetidentifierT >::STDPCosConnection()
+template < typename targetidentifierT, typename realT >
+STDPCosConnection< targetidentifierT, realT >::STDPCosConnection()
   : ConnectionBase(),
   weight_( 1.0 ),
   last_spike_weight_change_( 0.0 ),
@@ -199,12 +226,14 @@ STDPCosConnection< targetidentifierT >::STDPCosConnection()
   A_minus_( 1.0 ),
   Wmin_( 0.0 ),
   Wmax_( 200.0 ),
-  t_lastspike( 0.0 )
+  t_lastspike( 0.0 ),
+  plastic_( true ),
+  registered_( false )
 {
 }
 
-template < typename targetidentifierT >
-STDPCosConnection< targetidentifierT >::STDPCosConnection( const STDPCosConnection& rhs )
+template < typename targetidentifierT, typename realT >
+STDPCosConnection< targetidentifierT, realT >::STDPCosConnection( const STDPCosConnection& rhs )
   : ConnectionBase( rhs )
   , weight_( rhs.weight_ )
   , last_spike_weight_change_ ( rhs.last_spike_weight_change_ )
@@ -219,12 +248,14 @@ STDPCosConnection< targetidentifierT >::STDPCosConnection( const STDPCosConnecti
   , Wmin_( rhs.Wmin_ )
   , Wmax_( rhs.Wmax_ )
   , t_lastspike( rhs.t_lastspike )
+  , plastic_( rhs.plastic_ )
+  , registered_( rhs.registered_ )
 {
 }
 
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT >
 void
-STDPCosConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+STDPCosConnection< targetidentifierT, realT >::get_status( DictionaryDatum& d ) const
 {
 
   // base class properties, different for individual synapse
@@ -235,17 +266,19 @@ STDPCosConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
   def< double >( d, "Wmax", Wmax_ );
   def< double >( d, "tau_cos", 1./this->inv_tau_);
   def< double >( d, nest::names::weight, this->weight_ );
+  def< bool >( d, "plastic", this->plastic_ );
 
   def< double >( d, "exponent", this->exponent_ );
 }
 
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT >
 void
-STDPCosConnection< targetidentifierT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+STDPCosConnection< targetidentifierT, realT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
 {
   // base class properties
   ConnectionBase::set_status( d, cm );
   updateValue< double >( d, nest::names::weight, weight_ );
+  updateValue< bool >( d, "plastic", plastic_ );
 
   updateValue< double >( d, "A_plus", A_plus_ );
   updateValue< double >( d, "A_minus", A_minus_ );
@@ -257,16 +290,27 @@ STDPCosConnection< targetidentifierT >::set_status( const DictionaryDatum& d, ne
   double new_tau_cos;
   updateValue< double >( d, "tau_cos", new_tau_cos );
   this->inv_tau_ = 1./new_tau_cos;
+
+  // The target stops keeping the history for this synapse as soon as it is
+  // frozen. Only connected synapses are registered, not the default
+  // connection changed by SetDefaults, whose value is copied to the new
+  // connections and checked in check_connection.
+  if ( !this->plastic_ && this->registered_ )
+  {
+    nest::Node* target = get_target( get_connection_thread( this->get_syn_id(), cm ) );
+    static_cast< Archiving_Node_Cos* >( target )->unregister_stdp_connection_cos( this->t_last_update_ );
+    this->registered_ = false;
+  }
 }
 
-template < typename targetidentifierT >
-void STDPCosConnection< targetidentifierT >::evolve_cos_values( double ElapsedTime,
-                                  double oldcos2,
-                                  double oldsin2,
-                                  double oldcossin,
-                                  double& cos2,
-                                  double& sin2,
-                                  double& cossin){
+template < typename targetidentifierT, typename realT >
+void STDPCosConnection< targetidentifierT, realT >::evolve_cos_values( realT ElapsedTime,
+                                  realT oldcos2,
+                                  realT oldsin2,
+                                  realT oldcossin,
+                                  realT& cos2,
+                                  realT& sin2,
+                                  realT& cossin){
 
     float ElapsedRelative = this->exponent_*ElapsedTime*this->inv_tau_;
     float expon = ExponentialTable::GetResult(-ElapsedRelative);
@@ -297,9 +341,9 @@ void STDPCosConnection< targetidentifierT >::evolve_cos_values( double ElapsedTi
  * \param p The port under which this connection is stored in the Connector.
  * \param t_lastspike Time point of last spike emitted
  */
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT >
 inline void
-STDPCosConnection< targetidentifierT >::send( nest::Event& e,
+STDPCosConnection< targetidentifierT, realT >::send( nest::Event& e,
   nest::thread t,
   const nest::CommonSynapseProperties& cp )
 {
@@ -307,14 +351,44 @@ STDPCosConnection< targetidentifierT >::send( nest::Event& e,
 
   //std::cout << "Synapse parameters: Aplus: " << this->A_plus_ << ". Aminus: " << this->A_minus_ << ". Wmin: " << this->Wmin_ << ". Wmax: " << this->Wmax_ << ". Expon: " << this->exponent_ << ". Tau: " << 1./this->inv_tau_ << ". Weight: " << this->weight_ << std::endl;
 
-  nest::Node* target = get_target( t );
+  // Resolve the target only once, since with TargetIdentifierIndex (the _hpc
+  // models) it is looked up from its thread-local index
+  mynest::Archiving_Node_Cos* target = static_cast< mynest::Archiving_Node_Cos* >( get_target( t ) );
 
   // purely dendritic delay
   //float dendritic_delay = get_delay();
-  double t_spike = e.get_stamp().get_ms();
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
 
   double new_cos2_, new_sin2_, new_cossin_;
 
+  if ( !this->plastic_ )
+  {
+    // Plasticity is frozen: deliver the spike as a static synapse
+    e.set_receiver( *target );
+    e.set_weight( weight_ );
+    e.set_delay_steps( get_delay_steps() );
+    e.set_rport( get_rport() );
+    e();
+
+    t_lastspike = t_spike;
+    return;
+  }
+
+  if ( !this->registered_ )
+  {
+    // Plasticity has been enabled again: the learning rule restarts from
+    // this spike, ignoring the activity while it was frozen
+    target->register_stdp_connection_cos( t_spike );
+    this->registered_ = true;
+
+    this->cos2_ = 0.0;
+    this->sin2_ = 0.0;
+    this->cossin_ = 0.0;
+    this->last_spike_weight_change_ = 0.0;
+    this->t_last_update_ = t_spike;
+  }
+
   //std::cout << "Processing PF spike at time " << t_spike << "Last update: " << this->t_last_update_ << std::endl;
 
   this->weight_ += this->last_spike_weight_change_;
@@ -328,24 +402,25 @@ STDPCosConnection< targetidentifierT >::send( nest::Event& e,
   std::deque<mynest::histentry_cos>::iterator start;
   std::deque<mynest::histentry_cos>::iterator finish;
   //((mynest::Archiving_Node_Sym *)target_)->get_sym_history(t_lastspike - dendritic_delay, t_spike - dendritic_delay,&start, &finish);
-  ((mynest::Archiving_Node_Cos *)target)->get_cos_history(this->t_last_update_, t_spike,&start, &finish);
+  target->get_cos_history(this->t_last_update_, t_spike,&start, &finish);
   //weight change due to post-synaptic spikes since last pre-synaptic spike
   while (start != finish){
+    const double t_cs = target->get_cos_time( *start );
 
      // Evolve the state variables until the CS spike time
-    this->evolve_cos_values( start->t_ - this->t_last_update_,
+    this->evolve_cos_values( t_cs - this->t_last_update_,
                               this->cos2_, this->sin2_, this->cossin_,
                               this->cos2_, this->sin2_, this->cossin_);
 
-    this->t_last_update_ = start->t_;
+    this->t_last_update_ = t_cs;
 
     // Update the synaptic weight due to CS
-    this->weight_ -= this->A_minus_*this->cos2_;
+    this->weight_ -= this->A_minus_*start->multiplicity_*this->cos2_;
 
     // Check wether the weight stays within the boundaries
     this->weight_ = this->check_weight_boundaries(this->weight_);
 
-    //std::cout << "Applying LTD with spike at time: " << start->t_ << ". New weight: " << this->weight_ << std::endl;
+    //std::cout << "Applying LTD with spike at time: " << t_cs << ". New weight: " << this->weight_ << std::endl;
 
     ++start;
   }
@@ -361,7 +436,7 @@ STDPCosConnection< targetidentifierT >::send( nest::Event& e,
 
   // Obtain weight change due to this spike (it will be applied when processing the
   // next presynaptic spike)
-  ((mynest::Archiving_Node_Cos *)target)->get_cos_values( t_spike, new_cos2_, new_sin2_, new_cossin_);
+  target->get_cos_values( t_spike, new_cos2_, new_sin2_, new_cossin_);
 
   // Apply the LTD and LTP due to the previous presynaptic spike
   this->last_spike_weight_change_ = this->A_plus_ - this->A_minus_*new_cos2_;
@@ -380,8 +455,8 @@ STDPCosConnection< targetidentifierT >::send( nest::Event& e,
 }
 
 
-template < typename targetidentifierT >
-inline double STDPCosConnection< targetidentifierT >::check_weight_boundaries(double weight){
+template < typename targetidentifierT, typename realT >
+inline realT STDPCosConnection< targetidentifierT, realT >::check_weight_boundaries(realT weight){
   if (weight_ > this->Wmax_){
     return this->Wmax_;
   } else if (weight < this->Wmin_) {
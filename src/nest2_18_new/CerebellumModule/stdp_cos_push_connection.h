@@ -0,0 +1,293 @@
+/*
+ *  stdp_cos_push_connection.h
+ */
+
+#ifndef STDP_COS_PUSH_CONNECTION_H
+#define STDP_COS_PUSH_CONNECTION_H
+
+/* BeginDocumentation
+
+   Name: stdp_cos_push_synapse - Synapse type for DCN-like spike-timing
+   dependent plasticity with LTD computed by the target neuron.
+
+   Description:
+   stdp_cos_push_synapse implements the same learning rule as
+   stdp_cos_synapse, but the presynaptic trace of the synapse is stored by
+   the target neuron, next to the traces of the rest of its push-mode
+   synapses. When the teaching signal arrives, the neuron computes the LTD
+   of all of them in a single vectorized sweep and accumulates it, and each
+   synapse applies its accumulated LTD when its next presynaptic spike
+   arrives. Neither the synapse nor the neuron walk a teaching spike history,
+   so this model suits rare teaching signals with dense presynaptic activity.
+
+   Parameters:
+      A_plus    double - Amplitude of weight change for facilitation
+      A_minus   double - Amplitude of weight change for depression
+      Wmin      double - Minimal synaptic weight
+      Wmax      double - Maximal synaptic weight
+
+   Transmits: SpikeEvent
+
+   Remarks:
+   - The kernel of the learning rule is defined by the tau_cos and exponent
+     parameters of the target neuron.
+   - A presynaptic spike processed before an earlier teaching spike (because
+     it has a shorter delay) does not see that teaching spike in time; the
+     trace right before the presynaptic spike is used instead.
+   - The slot of the presynaptic trace in the target is released when the
+     connection is disconnected, and reused by the next connection.
+   - A presynaptic spike processed after a later teaching spike (because it
+     has a longer delay) adds the LTD it causes at that teaching spike when
+     it arrives, as long as the teaching spike is within the max delay.
+
+   SeeAlso: stdp_cos_synapse, iaf_cond_exp_cos
+*/
+
+#include "common_synapse_properties.h"
+
+#include "connection.h"
+#include "archiving_node_cos.h"
+
+namespace mynest
+{
+
+/**
+ * Class representing an STDPCosPushConnection.
+ */
+template < typename targetidentifierT >
+class STDPCosPushConnection : public nest::Connection< targetidentifierT >
+{
+
+public:
+  typedef nest::CommonSynapseProperties CommonPropertiesType;
+  typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+  /**
+   * Default Constructor.
+   * Sets default values for all parameters. Needed by GenericConnectorModel.
+   */
+  STDPCosPushConnection();
+
+  /**
+   * Copy constructor from a property object.
+   * Needs to be defined properly in order for GenericConnector to work.
+   */
+  STDPCosPushConnection( const STDPCosPushConnection& );
+
+  // Explicitly declare all methods inherited from the dependent base ConnectionBase.
+  // This avoids explicit name prefixes in all places these functions are used.
+  // Since ConnectionBase depends on the template parameter, they are not automatically
+  // found in the base class.
+  using ConnectionBase::get_delay_steps;
+  using ConnectionBase::get_rport;
+  using ConnectionBase::get_target;
+
+  /**
+   * Get all properties of this connection and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties of this connection from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Send an event to the receiver of this connection.
+   * \param e The event to send
+   */
+  void send( nest::Event& e, nest::thread t, const nest::CommonSynapseProperties& cp );
+
+  class ConnTestDummyNode : public nest::ConnTestDummyNodeBase
+  {
+  public:
+    // Ensure proper overriding of overloaded virtual functions.
+    // Return values from functions are ignored.
+    using ConnTestDummyNodeBase::handles_test_event;
+    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+    {
+      return nest::invalid_port_;
+    }
+  };
+
+  /*
+   * This function calls check_connection on the sender and checks if the receiver
+   * accepts the event type and receptor type requested by the sender.
+   * Node::check_connection() will either confirm the receiver port by returning
+   * true or false if the connection should be ignored.
+   *
+   * \param s The source node
+   * \param r The target node
+   * \param receptor_type The ID of the requested receptor type
+   */
+  void
+  check_connection( nest::Node& s,
+    nest::Node& t,
+    nest::rport receptor_type,
+    const CommonPropertiesType& cp )
+  {
+    ConnTestDummyNode dummy_target;
+    ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+    slot_ = ((Archiving_Node_Cos *) (&t))->register_push_connection_cos();
+  }
+
+  /**
+   * Disable the connection when it is disconnected, and release its slot in
+   * the target. Connector calls disable on the type of its connections, so
+   * this hides Connection::disable. A failed Connect never registers a slot,
+   * because the slot is taken after all the checks of check_connection, and
+   * ResetNetwork keeps the connections and their slots.
+   */
+  void
+  disable()
+  {
+    static_cast< Archiving_Node_Cos* >( get_target( 0 ) )->unregister_push_connection_cos( slot_ );
+    ConnectionBase::disable();
+  }
+
+  void
+  set_weight( double w )
+  {
+    weight_ = w;
+  }
+
+private:
+  // data members of each connection
+  double weight_;
+
+  double last_spike_weight_change_;
+
+  // Position of the presynaptic trace in the target
+  unsigned int slot_;
+
+  double A_plus_;
+  double A_minus_;
+  double Wmin_;
+  double Wmax_;
+
+  double check_weight_boundaries(double weight);
+};
+
+//
+// Implementation of class STDPCosPushConnection.
+//
+
+template < typename targetidentifierT >
+STDPCosPushConnection< targetidentifierT >::STDPCosPushConnection()
+  : ConnectionBase(),
+  weight_( 1.0 ),
+  last_spike_weight_change_( 0.0 ),
+  slot_( 0 ),
+  A_plus_( 1.0 ),
+  A_minus_( 1.0 ),
+  Wmin_( 0.0 ),
+  Wmax_( 200.0 )
+{
+}
+
+template < typename targetidentifierT >
+STDPCosPushConnection< targetidentifierT >::STDPCosPushConnection( const STDPCosPushConnection& rhs )
+  : ConnectionBase( rhs )
+  , weight_( rhs.weight_ )
+  , last_spike_weight_change_ ( rhs.last_spike_weight_change_ )
+  , slot_( rhs.slot_ )
+  , A_plus_( rhs.A_plus_ )
+  , A_minus_( rhs.A_minus_ )
+  , Wmin_( rhs.Wmin_ )
+  , Wmax_( rhs.Wmax_ )
+{
+}
+
+template < typename targetidentifierT >
+void
+STDPCosPushConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+{
+
+  // base class properties, different for individual synapse
+  ConnectionBase::get_status( d );
+  def< double >( d, "A_plus", A_plus_ );
+  def< double >( d, "A_minus", A_minus_ );
+  def< double >( d, "Wmin", Wmin_ );
+  def< double >( d, "Wmax", Wmax_ );
+  def< double >( d, nest::names::weight, this->weight_ );
+}
+
+template < typename targetidentifierT >
+void
+STDPCosPushConnection< targetidentifierT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  // base class properties
+  ConnectionBase::set_status( d, cm );
+  updateValue< double >( d, nest::names::weight, weight_ );
+
+  updateValue< double >( d, "A_plus", A_plus_ );
+  updateValue< double >( d, "A_minus", A_minus_ );
+
+  updateValue< double >( d, "Wmin", Wmin_ );
+  updateValue< double >( d, "Wmax", Wmax_ );
+}
+
+/**
+ * Send an event to the receiver of this connection.
+ * \param e The event to send
+ * \param p The port under which this connection is stored in the Connector.
+ */
+template < typename targetidentifierT >
+inline void
+STDPCosPushConnection< targetidentifierT >::send( nest::Event& e,
+  nest::thread t,
+  const nest::CommonSynapseProperties& )
+{
+  mynest::Archiving_Node_Cos* target = static_cast< mynest::Archiving_Node_Cos* >( get_target( t ) );
+
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
+
+  double new_cos2_, new_sin2_, new_cossin_;
+
+  this->weight_ += this->last_spike_weight_change_;
+
+  // Check wether the weight stays within the boundaries
+  this->weight_ = this->check_weight_boundaries(this->weight_);
+
+  // Apply the LTD computed by the target for the teaching spikes since the
+  // last presynaptic spike. All the terms are depressing, so clipping the
+  // total change is equivalent to clipping after every teaching spike.
+  this->weight_ -= this->A_minus_*target->take_push_ltd_cos( this->slot_ );
+
+  // Check wether the weight stays within the boundaries
+  this->weight_ = this->check_weight_boundaries(this->weight_);
+
+  // Add this spike to the presynaptic trace stored in the target
+  target->add_push_spike_cos( this->slot_, t_spike );
+
+  // Obtain weight change due to this spike (it will be applied when processing the
+  // next presynaptic spike)
+  target->get_cos_values( t_spike, new_cos2_, new_sin2_, new_cossin_);
+
+  // Apply the LTD and LTP due to the previous presynaptic spike
+  this->last_spike_weight_change_ = this->A_plus_ - this->A_minus_*new_cos2_;
+
+  e.set_receiver( *target );
+  e.set_weight( weight_ );
+  e.set_delay_steps( get_delay_steps() );
+  e.set_rport( get_rport() );
+  e();
+}
+
+
+template < typename targetidentifierT >
+inline double STDPCosPushConnection< targetidentifierT >::check_weight_boundaries(double weight){
+  if (weight > this->Wmax_){
+    return this->Wmax_;
+  } else if (weight < this->Wmin_) {
+    return this->Wmin_;
+  }
+
+  return weight;
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef STDP_COS_PUSH_CONNECTION_H
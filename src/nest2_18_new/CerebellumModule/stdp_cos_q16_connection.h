@@ -0,0 +1,416 @@
+/*
+ *  stdp_cos_q16_connection.h
+ */
+
+#ifndef STDP_COS_Q16_CONNECTION_H
+#define STDP_COS_Q16_CONNECTION_H
+
+/* BeginDocumentation
+
+   Name: stdp_cos_q16_synapse - Synapse type for DCN-like spike-timing
+   dependent plasticity with 16-bit weights.
+
+   Description:
+   stdp_cos_q16_synapse implements the same learning rule as
+   stdp_cos_synapse, but the weight is stored as a 16-bit fixed point value
+   between Wmin and Wmax, and the state variables in single precision. The
+   parameters of the learning rule are common properties, and they can only
+   be set with SetDefaults or CopyModel.
+
+   After every presynaptic spike the updated weight is rounded to the nearest
+   representable value, or stochastically if stochastic_rounding is true.
+   The stochastic rounding draws its random numbers from a counter-based
+   generator keyed by the source, the target, the spike step and rng_seed,
+   so the weights do not depend on the number of threads or processes.
+   The resolution of the weight is (Wmax-Wmin)/65535.
+
+   Common properties:
+      A_plus    double - Amplitude of weight change for facilitation
+      A_minus   double - Amplitude of weight change for depression
+      Wmin      double - Minimal synaptic weight
+      Wmax      double - Maximal synaptic weight
+      exponent  double - Exponent of the sin function. The lower the exponent the wider the kernel function.
+      tau_cos   double - Time constant of the learning rule (in ms)
+      stochastic_rounding  bool - Round the weight updates stochastically (default true)
+      rng_seed  int    - Seed of the stochastic rounding (default 0)
+
+   Transmits: SpikeEvent
+
+   Remarks:
+   - Wmin and Wmax can only be set before creating the connections, and
+     together with the default weight, which is stored in their range.
+
+   SeeAlso: stdp_cos_synapse, iaf_cond_exp_cos
+*/
+
+#include "connection.h"
+#include "archiving_node_cos.h"
+
+#include "common_properties_check.h"
+#include "stdp_q16_common_properties.h"
+
+#include "ExponentialTable.h"
+#include "TrigonometricTable.h"
+
+namespace mynest
+{
+
+/**
+ * Class containing the common properties for all synapses of type
+ * STDPCosQ16Connection.
+ */
+class STDPCosQ16CommonProperties : public STDPQ16CommonProperties
+{
+
+public:
+  /**
+   * Default constructor.
+   * Sets all property values to defaults.
+   */
+  STDPCosQ16CommonProperties();
+
+  /**
+   * Get all properties and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  void evolve_cos_values( double ElapsedTime,
+                          float oldcos2, float oldsin2, float oldcossin,
+                          float& cos2, float& sin2, float& cossin) const;
+
+  double exponent_;
+  double inv_tau_;
+};
+
+inline
+STDPCosQ16CommonProperties::STDPCosQ16CommonProperties()
+  : STDPQ16CommonProperties()
+  , exponent_( 2 )
+  , inv_tau_( 1.0 )
+{
+}
+
+inline void
+STDPCosQ16CommonProperties::get_status( DictionaryDatum& d ) const
+{
+  STDPQ16CommonProperties::get_status( d );
+
+  def< double >( d, "tau_cos", 1./this->inv_tau_);
+  def< double >( d, "exponent", this->exponent_ );
+}
+
+inline void
+STDPCosQ16CommonProperties::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  STDPQ16CommonProperties::set_status( d, cm );
+
+  updateValue< double >( d, "exponent", exponent_ );
+  double new_tau_cos = 1./this->inv_tau_;
+  updateValue< double >( d, "tau_cos", new_tau_cos );
+
+  if ( new_tau_cos <= 0.0 )
+  {
+    throw nest::BadProperty( "All time constants must be strictly positive." );
+  }
+  this->inv_tau_ = 1./new_tau_cos;
+}
+
+inline void
+STDPCosQ16CommonProperties::evolve_cos_values( double ElapsedTime,
+                                  float oldcos2,
+                                  float oldsin2,
+                                  float oldcossin,
+                                  float& cos2,
+                                  float& sin2,
+                                  float& cossin) const
+{
+  float ElapsedRelative = this->exponent_*ElapsedTime*this->inv_tau_;
+  float expon = ExponentialTable::GetResult(-ElapsedRelative);
+
+  float ElapsedRelativeTrigonometric=ElapsedTime*this->inv_tau_*1.5708f;
+
+  int LUTindex=TrigonometricTable::CalculateOffsetPosition(ElapsedRelativeTrigonometric);
+  LUTindex = TrigonometricTable::CalculateValidPosition(0,LUTindex);
+
+  float SinVar = TrigonometricTable::GetElement(LUTindex);
+  float CosVar = TrigonometricTable::GetElement(LUTindex+1);
+
+  float auxCos2=CosVar*CosVar;
+  float auxSin2=SinVar*SinVar;
+  float auxCosSin=CosVar*SinVar;
+
+  cos2 = expon*(oldcos2 * auxCos2 + oldsin2*auxSin2-2*oldcossin*auxCosSin);
+  sin2 = expon*(oldsin2 * auxCos2 + oldcos2*auxSin2+2*oldcossin*auxCosSin);
+  cossin = expon*(oldcossin *(auxCos2-auxSin2) + (oldcos2-oldsin2)*auxCosSin);
+}
+
+
+/**
+ * Class representing an STDPCosQ16Connection.
+ */
+template < typename targetidentifierT >
+class STDPCosQ16Connection : public nest::Connection< targetidentifierT >
+{
+
+public:
+  typedef STDPCosQ16CommonProperties CommonPropertiesType;
+  typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+  /**
+   * Default Constructor.
+   * Sets default values for all parameters. Needed by GenericConnectorModel.
+   */
+  STDPCosQ16Connection();
+
+  /**
+   * Copy constructor from a property object.
+   * Needs to be defined properly in order for GenericConnector to work.
+   */
+  STDPCosQ16Connection( const STDPCosQ16Connection& );
+
+  // Explicitly declare all methods inherited from the dependent base ConnectionBase.
+  // This avoids explicit name prefixes in all places these functions are used.
+  // Since ConnectionBase depends on the template parameter, they are not automatically
+  // found in the base class.
+  using ConnectionBase::get_delay;
+  using ConnectionBase::get_delay_steps;
+  using ConnectionBase::get_rport;
+  using ConnectionBase::get_syn_id;
+  using ConnectionBase::get_target;
+
+  /**
+   * Get all properties of this connection and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties of this connection from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Send an event to the receiver of this connection.
+   * \param e The event to send
+   */
+  void send( nest::Event& e, nest::thread t, const CommonPropertiesType& cp );
+
+  class ConnTestDummyNode : public nest::ConnTestDummyNodeBase
+  {
+  public:
+    // Ensure proper overriding of overloaded virtual functions.
+    // Return values from functions are ignored.
+    using ConnTestDummyNodeBase::handles_test_event;
+    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+    {
+      return nest::invalid_port_;
+    }
+  };
+
+  /*
+   * This function calls check_connection on the sender and checks if the receiver
+   * accepts the event type and receptor type requested by the sender.
+   * Node::check_connection() will either confirm the receiver port by returning
+   * true or false if the connection should be ignored.
+   *
+   * \param s The source node
+   * \param r The target node
+   * \param receptor_type The ID of the requested receptor type
+   */
+  void
+  check_connection( nest::Node& s,
+    nest::Node& t,
+    nest::rport receptor_type,
+    const CommonPropertiesType& cp )
+  {
+    ConnTestDummyNode dummy_target;
+    ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+    ((Archiving_Node_Cos *) (&t))->register_stdp_connection_cos( t_last_update_ - get_delay() );
+  }
+
+  /**
+   * The learning rule parameters are common properties, so they cannot be
+   * set for individual connections.
+   */
+  void
+  check_synapse_params( const DictionaryDatum& syn_spec ) const
+  {
+    const std::string param_arr[] = { "A_plus", "A_minus", "Wmin", "Wmax", "stochastic_rounding", "rng_seed", "exponent", "tau_cos" };
+    check_no_common_properties( syn_spec, param_arr, sizeof( param_arr ) / sizeof( std::string ), "stdp_cos_q16_synapse" );
+  }
+
+  void
+  set_weight( double w )
+  {
+    weight_ = get_q16_common_properties< CommonPropertiesType >( get_syn_id() ).quantize_weight( w );
+  }
+
+private:
+  // data members of each connection
+  unsigned short int weight_;
+
+  float last_spike_weight_change_;
+
+  // Cos^2 accumulation variable
+  float cos2_;
+
+  // Sin^2 accumulation variable
+  float sin2_;
+
+  // Cos*Sin accumulation variable
+  float cossin_;
+
+  double t_last_update_;
+};
+
+//
+// Implementation of class STDPCosQ16Connection.
+//
+
+template < typename targetidentifierT >
+STDPCosQ16Connection< targetidentifierT >::STDPCosQ16Connection()
+  : ConnectionBase(),
+  weight_( STDPCosQ16CommonProperties().quantize_weight( 1.0 ) ),
+  last_spike_weight_change_( 0.0f ),
+  cos2_( 0.0f ),
+  sin2_( 0.0f ),
+  cossin_( 0.0f ),
+  t_last_update_( 0.0 )
+{
+}
+
+template < typename targetidentifierT >
+STDPCosQ16Connection< targetidentifierT >::STDPCosQ16Connection( const STDPCosQ16Connection& rhs )
+  : ConnectionBase( rhs )
+  , weight_( rhs.weight_ )
+  , last_spike_weight_change_ ( rhs.last_spike_weight_change_ )
+  , cos2_( rhs.cos2_ )
+  , sin2_( rhs.sin2_ )
+  , cossin_( rhs.cossin_ )
+  , t_last_update_( rhs.t_last_update_ )
+{
+}
+
+template < typename targetidentifierT >
+void
+STDPCosQ16Connection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+{
+  // base class properties, different for individual synapse
+  ConnectionBase::get_status( d );
+  def< double >( d, nest::names::weight,
+    get_q16_common_properties< CommonPropertiesType >( get_syn_id() ).get_weight( this->weight_ ) );
+}
+
+template < typename targetidentifierT >
+void
+STDPCosQ16Connection< targetidentifierT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  // The common properties are also passed here by SetDefaults, so only
+  // values different from the current ones are rejected
+  const CommonPropertiesType& cp = static_cast< const CommonPropertiesType& >( cm.get_common_properties() );
+  check_common_property( d, "A_plus", cp.A_plus_, "stdp_cos_q16_synapse" );
+  check_common_property( d, "A_minus", cp.A_minus_, "stdp_cos_q16_synapse" );
+  check_common_property( d, "Wmin", cp.Wmin_, "stdp_cos_q16_synapse" );
+  check_common_property( d, "Wmax", cp.Wmax_, "stdp_cos_q16_synapse" );
+  check_common_property( d, "stochastic_rounding", cp.stochastic_rounding_, "stdp_cos_q16_synapse" );
+  check_common_property( d, "rng_seed", cp.rng_seed_, "stdp_cos_q16_synapse" );
+  check_common_property( d, "exponent", cp.exponent_, "stdp_cos_q16_synapse" );
+
+  // The time constant is stored as its inverse
+  double tau_cos = 1./cp.inv_tau_;
+  if ( updateValue< double >( d, "tau_cos", tau_cos ) && 1./tau_cos != cp.inv_tau_ )
+  {
+    throw nest::BadProperty( "tau_cos is a common property of stdp_cos_q16_synapse "
+      "and can only be set with SetDefaults or CopyModel." );
+  }
+
+  // base class properties
+  ConnectionBase::set_status( d, cm );
+
+  double weight;
+  if ( updateValue< double >( d, nest::names::weight, weight ) )
+  {
+    this->weight_ = cp.quantize_weight( weight );
+  }
+}
+
+/**
+ * Send an event to the receiver of this connection.
+ * \param e The event to send
+ * \param p The port under which this connection is stored in the Connector.
+ */
+template < typename targetidentifierT >
+inline void
+STDPCosQ16Connection< targetidentifierT >::send( nest::Event& e,
+  nest::thread t,
+  const CommonPropertiesType& cp )
+{
+  nest::Node* target = get_target( t );
+
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
+
+  double new_cos2_, new_sin2_, new_cossin_;
+
+  // The weight is updated in double precision and rounded once per spike
+  double weight = cp.get_weight( this->weight_ ) + this->last_spike_weight_change_;
+
+  // Check wether the weight stays within the boundaries
+  weight = cp.check_weight_boundaries(weight);
+
+  std::deque<mynest::histentry_cos>::iterator start;
+  std::deque<mynest::histentry_cos>::iterator finish;
+  ((mynest::Archiving_Node_Cos *)target)->get_cos_history(this->t_last_update_, t_spike,&start, &finish);
+  //weight change due to post-synaptic spikes since last pre-synaptic spike
+  while (start != finish){
+    const double t_cs = ((mynest::Archiving_Node_Cos *)target)->get_cos_time( *start );
+
+    // Evolve the state variables until the CS spike time
+    cp.evolve_cos_values( t_cs - this->t_last_update_,
+                          this->cos2_, this->sin2_, this->cossin_,
+                          this->cos2_, this->sin2_, this->cossin_);
+
+    this->t_last_update_ = t_cs;
+
+    // Update the synaptic weight due to CS
+    weight -= cp.A_minus_*start->multiplicity_*this->cos2_;
+
+    // Check wether the weight stays within the boundaries
+    weight = cp.check_weight_boundaries(weight);
+
+    ++start;
+  }
+
+  // Evolve the state variables until the presynaptic spike time
+  cp.evolve_cos_values( t_spike-this->t_last_update_,
+                        this->cos2_, this->sin2_, this->cossin_,
+                        this->cos2_, this->sin2_, this->cossin_);
+  // Apply the effect of the incoming spike into the state variables
+  this->cos2_ += 1.0f;
+
+  // Obtain weight change due to this spike (it will be applied when processing the
+  // next presynaptic spike)
+  ((mynest::Archiving_Node_Cos *)target)->get_cos_values( t_spike, new_cos2_, new_sin2_, new_cossin_);
+
+  // Apply the LTD and LTP due to the previous presynaptic spike
+  this->last_spike_weight_change_ = cp.A_plus_ - cp.A_minus_*new_cos2_;
+
+  this->t_last_update_ = t_spike;
+
+  this->weight_ = cp.quantize_weight( weight, e.get_sender_gid(), target->get_gid(), e.get_stamp().get_steps() );
+
+  e.set_receiver( *target );
+  e.set_weight( cp.get_weight( this->weight_ ) );
+  e.set_delay_steps( get_delay_steps() );
+  e.set_rport( get_rport() );
+  e();
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef STDP_COS_Q16_CONNECTION_H
@@ -0,0 +1,541 @@
+/*
+ *  stdp_cos_shared_connection.h
+ */
+
+#ifndef STDP_COS_SHARED_CONNECTION_H
+#define STDP_COS_SHARED_CONNECTION_H
+
+/* BeginDocumentation
+
+   Name: stdp_cos_shared_synapse - Synapse type for DCN-like spike-timing
+   dependent plasticity with presynaptic traces shared between targets.
+
+   Description:
+   stdp_cos_shared_synapse implements the same learning rule as
+   stdp_cos_synapse. The cos2/sin2/cossin trace only depends on the
+   presynaptic spike train and the kernel parameters, so instead of storing and
+   evolving it in every synapse, it is kept once per presynaptic neuron in the
+   common properties of the synapse model. The trace is evolved by the first
+   synapse receiving each presynaptic spike and reused by the remaining targets
+   of the same neuron, and each synapse only stores its weight.
+
+   All the parameters of the learning rule are common properties, and they
+   can only be set with SetDefaults or CopyModel. Giving them to Connect or
+   changing them in the status of a single connection is an error.
+
+   Common properties:
+      A_plus    double - Amplitude of weight change for facilitation
+      A_minus   double - Amplitude of weight change for depression
+      Wmin      double - Minimal synaptic weight
+      Wmax      double - Maximal synaptic weight
+      exponent  double - Exponent of the sin function. The lower the exponent the wider the kernel function.
+      tau_cos   double - Time constant of the learning rule (in ms)
+
+   Transmits: SpikeEvent
+
+   Remarks:
+   - Every thread keeps its own copy of the common properties, so the trace
+     of each presynaptic neuron is evolved once per thread holding targets of
+     that neuron.
+
+   SeeAlso: stdp_cos_synapse, iaf_cond_exp_cos
+*/
+
+#include "common_synapse_properties.h"
+
+#include "connection.h"
+#include "archiving_node_cos.h"
+#include "common_properties_check.h"
+
+#include "ExponentialTable.h"
+#include "TrigonometricTable.h"
+
+#include <map>
+
+namespace mynest
+{
+
+/**
+ * Trace of the presynaptic activity of one neuron, right after its last two
+ * spikes.
+ */
+struct PresynapticTraceCos
+{
+  PresynapticTraceCos();
+
+  double t_prev_;
+  double cos2_prev_;
+  double sin2_prev_;
+  double cossin_prev_;
+
+  double t_last_;
+  double cos2_last_;
+  double sin2_last_;
+  double cossin_last_;
+};
+
+inline PresynapticTraceCos::PresynapticTraceCos()
+  : t_prev_( 0.0 )
+  , cos2_prev_( 0.0 )
+  , sin2_prev_( 0.0 )
+  , cossin_prev_( 0.0 )
+  , t_last_( 0.0 )
+  , cos2_last_( 0.0 )
+  , sin2_last_( 0.0 )
+  , cossin_last_( 0.0 )
+{
+}
+
+/**
+ * Class containing the common properties for all synapses of type
+ * STDPCosSharedConnection, including the traces of the presynaptic neurons.
+ */
+class STDPCosSharedCommonProperties : public nest::CommonSynapseProperties
+{
+
+public:
+  /**
+   * Default constructor.
+   * Sets all property values to defaults.
+   */
+  STDPCosSharedCommonProperties();
+
+  /**
+   * Copy constructor. The traces are not copied.
+   */
+  STDPCosSharedCommonProperties( const STDPCosSharedCommonProperties& );
+
+  /**
+   * Get all properties and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Return the trace of the presynaptic neuron source, evolved up to its
+   * spike at time t_spike if this is the first synapse receiving that spike.
+   */
+  const PresynapticTraceCos& get_trace( nest::index source, double t_spike ) const;
+
+  /**
+   * Return the time of the last spike of the presynaptic neuron source
+   * (0 if no spike has been received yet).
+   */
+  double get_last_spike( nest::index source ) const;
+
+  void evolve_cos_values( double ElapsedTime,
+                          double oldcos2, double oldsin2, double oldcossin,
+                          double& cos2, double& sin2, double& cossin) const;
+
+  double check_weight_boundaries( double weight ) const;
+
+  double exponent_;
+  double inv_tau_;
+
+  double A_plus_;
+  double A_minus_;
+  double Wmin_;
+  double Wmax_;
+
+private:
+  // Traces of the presynaptic neurons, indexed by their GID. They are only
+  // accessed from the thread owning this copy of the common properties.
+  mutable std::map< nest::index, PresynapticTraceCos > traces_;
+
+  // Last accessed trace, since all the targets of a spike are consecutive
+  mutable nest::index last_source_;
+  mutable PresynapticTraceCos* last_trace_;
+};
+
+inline
+STDPCosSharedCommonProperties::STDPCosSharedCommonProperties()
+  : nest::CommonSynapseProperties()
+  , exponent_( 2 )
+  , inv_tau_( 1.0 )
+  , A_plus_( 1.0 )
+  , A_minus_( 1.0 )
+  , Wmin_( 0.0 )
+  , Wmax_( 200.0 )
+  , traces_()
+  , last_source_( 0 )
+  , last_trace_( 0 )
+{
+}
+
+inline
+STDPCosSharedCommonProperties::STDPCosSharedCommonProperties( const STDPCosSharedCommonProperties& cp )
+  : nest::CommonSynapseProperties( cp )
+  , exponent_( cp.exponent_ )
+  , inv_tau_( cp.inv_tau_ )
+  , A_plus_( cp.A_plus_ )
+  , A_minus_( cp.A_minus_ )
+  , Wmin_( cp.Wmin_ )
+  , Wmax_( cp.Wmax_ )
+  , traces_()
+  , last_source_( 0 )
+  , last_trace_( 0 )
+{
+}
+
+inline void
+STDPCosSharedCommonProperties::get_status( DictionaryDatum& d ) const
+{
+  nest::CommonSynapseProperties::get_status( d );
+
+  def< double >( d, "A_plus", A_plus_ );
+  def< double >( d, "A_minus", A_minus_ );
+  def< double >( d, "Wmin", Wmin_ );
+  def< double >( d, "Wmax", Wmax_ );
+  def< double >( d, "tau_cos", 1./this->inv_tau_);
+  def< double >( d, "exponent", this->exponent_ );
+}
+
+inline void
+STDPCosSharedCommonProperties::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  nest::CommonSynapseProperties::set_status( d, cm );
+
+  updateValue< double >( d, "A_plus", A_plus_ );
+  updateValue< double >( d, "A_minus", A_minus_ );
+
+  updateValue< double >( d, "Wmin", Wmin_ );
+  updateValue< double >( d, "Wmax", Wmax_ );
+
+  double new_exponent = this->exponent_;
+  double new_tau_cos = 1./this->inv_tau_;
+  updateValue< double >( d, "exponent", new_exponent );
+  updateValue< double >( d, "tau_cos", new_tau_cos );
+
+  if ( new_tau_cos <= 0.0 )
+  {
+    throw nest::BadProperty( "All time constants must be strictly positive." );
+  }
+
+  // The stored traces are only valid for the kernel they were evolved with
+  if ( new_exponent != this->exponent_ || 1./new_tau_cos != this->inv_tau_ )
+  {
+    this->traces_.clear();
+    this->last_trace_ = 0;
+  }
+
+  this->exponent_ = new_exponent;
+  this->inv_tau_ = 1./new_tau_cos;
+}
+
+inline const PresynapticTraceCos&
+STDPCosSharedCommonProperties::get_trace( nest::index source, double t_spike ) const
+{
+  if ( this->last_trace_ == 0 || this->last_source_ != source )
+  {
+    this->last_trace_ = &this->traces_[ source ];
+    this->last_source_ = source;
+  }
+
+  PresynapticTraceCos& trace = *this->last_trace_;
+
+  if ( t_spike > trace.t_last_ )
+  {
+    // First target receiving this spike: keep the previous state, since the
+    // remaining targets still have to evolve it until their teaching spikes
+    trace.t_prev_ = trace.t_last_;
+    trace.cos2_prev_ = trace.cos2_last_;
+    trace.sin2_prev_ = trace.sin2_last_;
+    trace.cossin_prev_ = trace.cossin_last_;
+
+    // Evolve the state variables until the presynaptic spike time
+    this->evolve_cos_values( t_spike - trace.t_prev_,
+                             trace.cos2_prev_, trace.sin2_prev_, trace.cossin_prev_,
+                             trace.cos2_last_, trace.sin2_last_, trace.cossin_last_ );
+
+    // Apply the effect of the incoming spike into the state variables
+    trace.cos2_last_ += 1.0;
+    trace.t_last_ = t_spike;
+  }
+
+  return trace;
+}
+
+inline double
+STDPCosSharedCommonProperties::get_last_spike( nest::index source ) const
+{
+  std::map< nest::index, PresynapticTraceCos >::const_iterator it = this->traces_.find( source );
+  if ( it == this->traces_.end() )
+  {
+    return 0.0;
+  }
+  return it->second.t_last_;
+}
+
+inline void
+STDPCosSharedCommonProperties::evolve_cos_values( double ElapsedTime,
+                                  double oldcos2,
+                                  double oldsin2,
+                                  double oldcossin,
+                                  double& cos2,
+                                  double& sin2,
+                                  double& cossin) const
+{
+  float ElapsedRelative = this->exponent_*ElapsedTime*this->inv_tau_;
+  float expon = ExponentialTable::GetResult(-ElapsedRelative);
+
+  float ElapsedRelativeTrigonometric=ElapsedTime*this->inv_tau_*1.5708f;
+
+  int LUTindex=TrigonometricTable::CalculateOffsetPosition(ElapsedRelativeTrigonometric);
+  LUTindex = TrigonometricTable::CalculateValidPosition(0,LUTindex);
+
+  float SinVar = TrigonometricTable::GetElement(LUTindex);
+  float CosVar = TrigonometricTable::GetElement(LUTindex+1);
+
+  float auxCos2=CosVar*CosVar;
+  float auxSin2=SinVar*SinVar;
+  float auxCosSin=CosVar*SinVar;
+
+  cos2 = expon*(oldcos2 * auxCos2 + oldsin2*auxSin2-2*oldcossin*auxCosSin);
+  sin2 = expon*(oldsin2 * auxCos2 + oldcos2*auxSin2+2*oldcossin*auxCosSin);
+  cossin = expon*(oldcossin *(auxCos2-auxSin2) + (oldcos2-oldsin2)*auxCosSin);
+}
+
+inline double
+STDPCosSharedCommonProperties::check_weight_boundaries( double weight ) const
+{
+  if (weight > this->Wmax_){
+    return this->Wmax_;
+  } else if (weight < this->Wmin_) {
+    return this->Wmin_;
+  }
+
+  return weight;
+}
+
+
+/**
+ * Class representing an STDPCosSharedConnection.
+ */
+template < typename targetidentifierT >
+class STDPCosSharedConnection : public nest::Connection< targetidentifierT >
+{
+
+public:
+  typedef STDPCosSharedCommonProperties CommonPropertiesType;
+  typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+  /**
+   * Default Constructor.
+   * Sets default values for all parameters. Needed by GenericConnectorModel.
+   */
+  STDPCosSharedConnection();
+
+  /**
+   * Copy constructor from a property object.
+   * Needs to be defined properly in order for GenericConnector to work.
+   */
+  STDPCosSharedConnection( const STDPCosSharedConnection& );
+
+  // Explicitly declare all methods inherited from the dependent base ConnectionBase.
+  // This avoids explicit name prefixes in all places these functions are used.
+  // Since ConnectionBase depends on the template parameter, they are not automatically
+  // found in the base class.
+  using ConnectionBase::get_delay;
+  using ConnectionBase::get_delay_steps;
+  using ConnectionBase::get_rport;
+  using ConnectionBase::get_target;
+
+  /**
+   * Get all properties of this connection and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties of this connection from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Send an event to the receiver of this connection.
+   * \param e The event to send
+   */
+  void send( nest::Event& e, nest::thread t, const CommonPropertiesType& cp );
+
+  class ConnTestDummyNode : public nest::ConnTestDummyNodeBase
+  {
+  public:
+    // Ensure proper overriding of overloaded virtual functions.
+    // Return values from functions are ignored.
+    using ConnTestDummyNodeBase::handles_test_event;
+    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+    {
+      return nest::invalid_port_;
+    }
+  };
+
+  /*
+   * This function calls check_connection on the sender and checks if the receiver
+   * accepts the event type and receptor type requested by the sender.
+   * Node::check_connection() will either confirm the receiver port by returning
+   * true or false if the connection should be ignored.
+   *
+   * \param s The source node
+   * \param r The target node
+   * \param receptor_type The ID of the requested receptor type
+   */
+  void
+  check_connection( nest::Node& s,
+    nest::Node& t,
+    nest::rport receptor_type,
+    const CommonPropertiesType& cp )
+  {
+    ConnTestDummyNode dummy_target;
+    ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+    // The new synapse will start reading the history after the last spike
+    // of the presynaptic neuron
+    ((Archiving_Node_Cos *) (&t))->register_stdp_connection_cos( cp.get_last_spike( s.get_gid() ) - get_delay() );
+  }
+
+  /**
+   * The learning rule parameters are common properties, so they cannot be
+   * set for individual connections.
+   */
+  void
+  check_synapse_params( const DictionaryDatum& syn_spec ) const
+  {
+    const std::string param_arr[] = { "A_plus", "A_minus", "Wmin", "Wmax", "exponent", "tau_cos" };
+    check_no_common_properties( syn_spec, param_arr, sizeof( param_arr ) / sizeof( std::string ), "stdp_cos_shared_synapse" );
+  }
+
+  void
+  set_weight( double w )
+  {
+    weight_ = w;
+  }
+
+private:
+  // data members of each connection
+  double weight_;
+
+  double last_spike_weight_change_;
+};
+
+//
+// Implementation of class STDPCosSharedConnection.
+//
+
+template < typename targetidentifierT >
+STDPCosSharedConnection< targetidentifierT >::STDPCosSharedConnection()
+  : ConnectionBase(),
+  weight_( 1.0 ),
+  last_spike_weight_change_( 0.0 )
+{
+}
+
+template < typename targetidentifierT >
+STDPCosSharedConnection< targetidentifierT >::STDPCosSharedConnection( const STDPCosSharedConnection& rhs )
+  : ConnectionBase( rhs )
+  , weight_( rhs.weight_ )
+  , last_spike_weight_change_ ( rhs.last_spike_weight_change_ )
+{
+}
+
+template < typename targetidentifierT >
+void
+STDPCosSharedConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+{
+  // base class properties, different for individual synapse
+  ConnectionBase::get_status( d );
+  def< double >( d, nest::names::weight, this->weight_ );
+}
+
+template < typename targetidentifierT >
+void
+STDPCosSharedConnection< targetidentifierT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  // The common properties are also passed here by SetDefaults, so only
+  // values different from the current ones are rejected
+  const CommonPropertiesType& cp = static_cast< const CommonPropertiesType& >( cm.get_common_properties() );
+  check_common_property( d, "A_plus", cp.A_plus_, "stdp_cos_shared_synapse" );
+  check_common_property( d, "A_minus", cp.A_minus_, "stdp_cos_shared_synapse" );
+  check_common_property( d, "Wmin", cp.Wmin_, "stdp_cos_shared_synapse" );
+  check_common_property( d, "Wmax", cp.Wmax_, "stdp_cos_shared_synapse" );
+  check_common_property( d, "exponent", cp.exponent_, "stdp_cos_shared_synapse" );
+
+  // The time constant is stored as its inverse
+  double tau_cos = 1./cp.inv_tau_;
+  if ( updateValue< double >( d, "tau_cos", tau_cos ) && 1./tau_cos != cp.inv_tau_ )
+  {
+    throw nest::BadProperty( "tau_cos is a common property of stdp_cos_shared_synapse "
+      "and can only be set with SetDefaults or CopyModel." );
+  }
+
+  // base class properties
+  ConnectionBase::set_status( d, cm );
+  updateValue< double >( d, nest::names::weight, weight_ );
+}
+
+/**
+ * Send an event to the receiver of this connection.
+ * \param e The event to send
+ * \param p The port under which this connection is stored in the Connector.
+ */
+template < typename targetidentifierT >
+inline void
+STDPCosSharedConnection< targetidentifierT >::send( nest::Event& e,
+  nest::thread t,
+  const CommonPropertiesType& cp )
+{
+  nest::Node* target = get_target( t );
+
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
+
+  double cos2, sin2, cossin;
+  double new_cos2_, new_sin2_, new_cossin_;
+
+  this->weight_ += this->last_spike_weight_change_;
+
+  // Check wether the weight stays within the boundaries
+  this->weight_ = cp.check_weight_boundaries(this->weight_);
+
+  // Trace of the presynaptic neuron right after its previous spike
+  const PresynapticTraceCos& trace = cp.get_trace( e.get_sender_gid(), t_spike );
+
+  std::deque<mynest::histentry_cos>::iterator start;
+  std::deque<mynest::histentry_cos>::iterator finish;
+  ((mynest::Archiving_Node_Cos *)target)->get_cos_history(trace.t_prev_, t_spike,&start, &finish);
+  //weight change due to post-synaptic spikes since last pre-synaptic spike
+  while (start != finish){
+
+    // Evolve the state variables until the CS spike time
+    cp.evolve_cos_values( ((mynest::Archiving_Node_Cos *)target)->get_cos_time( *start ) - trace.t_prev_,
+                          trace.cos2_prev_, trace.sin2_prev_, trace.cossin_prev_,
+                          cos2, sin2, cossin );
+
+    // Update the synaptic weight due to CS
+    this->weight_ -= cp.A_minus_*start->multiplicity_*cos2;
+
+    // Check wether the weight stays within the boundaries
+    this->weight_ = cp.check_weight_boundaries(this->weight_);
+
+    ++start;
+  }
+
+  // Obtain weight change due to this spike (it will be applied when processing the
+  // next presynaptic spike)
+  ((mynest::Archiving_Node_Cos *)target)->get_cos_values( t_spike, new_cos2_, new_sin2_, new_cossin_);
+
+  // Apply the LTD and LTP due to the previous presynaptic spike
+  this->last_spike_weight_change_ = cp.A_plus_ - cp.A_minus_*new_cos2_;
+
+  e.set_receiver( *target );
+  e.set_weight( weight_ );
+  e.set_delay_steps( get_delay_steps() );
+  e.set_rport( get_rport() );
+  e();
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef STDP_COS_SHARED_CONNECTION_H
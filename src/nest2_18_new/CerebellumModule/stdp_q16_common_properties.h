@@ -0,0 +1,227 @@
+/*
+ *  stdp_q16_common_properties.h
+ */
+
+#ifndef STDP_Q16_COMMON_PROPERTIES_H
+#define STDP_Q16_COMMON_PROPERTIES_H
+
+#include "common_synapse_properties.h"
+#include "connector_model.h"
+#include "kernel_manager.h"
+
+#include "counter_rng.h"
+#include "synapse_model_lookup.h"
+
+#include <cmath>
+#include <stdint.h>
+
+namespace mynest
+{
+
+/**
+ * Common properties of the synapses storing their weight as a 16-bit fixed
+ * point code between Wmin (code 0) and Wmax (code MAX_WEIGHT_CODE).
+ */
+class STDPQ16CommonProperties : public nest::CommonSynapseProperties
+{
+
+public:
+  /**
+   * Code of the maximal weight.
+   */
+  static const unsigned short int MAX_WEIGHT_CODE = 65535;
+
+  /**
+   * Default constructor.
+   * Sets all property values to defaults.
+   */
+  STDPQ16CommonProperties();
+
+  /**
+   * Get all properties and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Weight represented by a code.
+   */
+  double
+  get_weight( unsigned short int code ) const
+  {
+    return this->Wmin_ + code * this->weight_step_;
+  }
+
+  /**
+   * Code of the nearest representable weight.
+   */
+  unsigned short int quantize_weight( double weight ) const;
+
+  /**
+   * Code of a weight after a plastic update by a spike of source at step
+   * of the synapse to target. With stochastic rounding the weight is rounded
+   * up with a probability proportional to its distance to the lower code, so
+   * that updates smaller than the resolution are not lost. The random number
+   * is drawn from the counter-based generator keyed by target and rng_seed at
+   * the counter (step, source), so the weights do not depend on the number
+   * of threads or processes.
+   */
+  unsigned short int quantize_weight( double weight, nest::index source, nest::index target, long step ) const;
+
+  double check_weight_boundaries( double weight ) const;
+
+  double A_plus_;
+  double A_minus_;
+  double Wmin_;
+  double Wmax_;
+
+  bool stochastic_rounding_;
+  long rng_seed_;
+
+private:
+  // Weight difference between consecutive codes
+  double weight_step_;
+
+  unsigned short int round_code( double code ) const;
+};
+
+inline
+STDPQ16CommonProperties::STDPQ16CommonProperties()
+  : nest::CommonSynapseProperties()
+  , A_plus_( 1.0 )
+  , A_minus_( 1.0 )
+  , Wmin_( 0.0 )
+  , Wmax_( 200.0 )
+  , stochastic_rounding_( true )
+  , rng_seed_( 0 )
+  , weight_step_( 200.0 / MAX_WEIGHT_CODE )
+{
+}
+
+inline void
+STDPQ16CommonProperties::get_status( DictionaryDatum& d ) const
+{
+  nest::CommonSynapseProperties::get_status( d );
+
+  def< double >( d, "A_plus", A_plus_ );
+  def< double >( d, "A_minus", A_minus_ );
+  def< double >( d, "Wmin", Wmin_ );
+  def< double >( d, "Wmax", Wmax_ );
+  def< bool >( d, "stochastic_rounding", stochastic_rounding_ );
+  def< long >( d, "rng_seed", rng_seed_ );
+}
+
+inline void
+STDPQ16CommonProperties::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  nest::CommonSynapseProperties::set_status( d, cm );
+
+  double new_Wmin = this->Wmin_;
+  double new_Wmax = this->Wmax_;
+  updateValue< double >( d, "Wmin", new_Wmin );
+  updateValue< double >( d, "Wmax", new_Wmax );
+
+  if ( new_Wmax <= new_Wmin )
+  {
+    throw nest::BadProperty( "Wmax must be greater than Wmin." );
+  }
+
+  // The weights are stored as codes of the weight range, so the range
+  // cannot change under existing connections. The default weight is also a
+  // code, and SetDefaults and CopyModel set it again from the new range.
+  if ( new_Wmin != this->Wmin_ || new_Wmax != this->Wmax_ )
+  {
+    if ( get_num_connections( cm ) > 0 )
+    {
+      throw nest::BadProperty( "Wmin and Wmax cannot be changed after connections of the model have been created." );
+    }
+
+    if ( !d->known( nest::names::weight ) )
+    {
+      throw nest::BadProperty( "The default weight must be given together with Wmin and Wmax." );
+    }
+  }
+
+  updateValue< double >( d, "A_plus", A_plus_ );
+  updateValue< double >( d, "A_minus", A_minus_ );
+  updateValue< bool >( d, "stochastic_rounding", stochastic_rounding_ );
+
+  long new_rng_seed = this->rng_seed_;
+  updateValue< long >( d, "rng_seed", new_rng_seed );
+  if ( new_rng_seed < 0 || new_rng_seed > 4294967295L )
+  {
+    throw nest::BadProperty( "The rng_seed parameter must be in [0, 2^32 - 1]." );
+  }
+  this->rng_seed_ = new_rng_seed;
+
+  this->Wmin_ = new_Wmin;
+  this->Wmax_ = new_Wmax;
+  this->weight_step_ = ( this->Wmax_ - this->Wmin_ ) / MAX_WEIGHT_CODE;
+}
+
+inline double
+STDPQ16CommonProperties::check_weight_boundaries( double weight ) const
+{
+  if (weight > this->Wmax_){
+    return this->Wmax_;
+  } else if (weight < this->Wmin_) {
+    return this->Wmin_;
+  }
+
+  return weight;
+}
+
+inline unsigned short int
+STDPQ16CommonProperties::round_code( double code ) const
+{
+  if ( code >= MAX_WEIGHT_CODE )
+  {
+    return MAX_WEIGHT_CODE;
+  }
+  return ( unsigned short int ) code;
+}
+
+inline unsigned short int
+STDPQ16CommonProperties::quantize_weight( double weight ) const
+{
+  const double code = ( this->check_weight_boundaries( weight ) - this->Wmin_ ) / this->weight_step_;
+  return this->round_code( std::floor( code + 0.5 ) );
+}
+
+inline unsigned short int
+STDPQ16CommonProperties::quantize_weight( double weight, nest::index source, nest::index target, long step ) const
+{
+  if ( !this->stochastic_rounding_ )
+  {
+    return this->quantize_weight( weight );
+  }
+
+  CounterRNG crng;
+  crng.set_key( target, static_cast< uint32_t >( this->rng_seed_ ) );
+  double u[ 4 ];
+  crng.uniforms( step, CounterRNG::ROUNDING_STREAM, static_cast< uint32_t >( source ), u );
+
+  const double code = ( this->check_weight_boundaries( weight ) - this->Wmin_ ) / this->weight_step_;
+  return this->round_code( std::floor( code + u[ 0 ] ) );
+}
+
+/**
+ * Common properties of the synapse model syn_id. Used where the synapse
+ * needs the weight range but NEST does not pass the common properties
+ * (set_weight and get_status).
+ */
+template < typename CommonPropertiesT >
+inline const CommonPropertiesT&
+get_q16_common_properties( nest::synindex syn_id )
+{
+  return static_cast< const CommonPropertiesT& >(
+    nest::kernel().model_manager.get_synapse_prototype( syn_id ).get_common_properties() );
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef STDP_Q16_COMMON_PROPERTIES_H
@@ -25,7 +25,18 @@
       Wmax      double - Maximal synaptic weight
       exponent  unsigned int - Exponent of the sin function (integer between 1 and 20). The lower the exponent the wider the kernel function.
       peak      double - Time (in ms) of the peak of the kernel function (typically 100ms for the cerebellar parallel fibers).
+      plastic   bool   - If false the weight is frozen and the synapse behaves as a static synapse (default true)
 
+   Freezing a connection with SetStatus stops its target from keeping the
+   history for it right away. Connections created after freezing the model
+   with SetDefaults are never registered in the history of their targets.
+
+   The model stdp_sin_synapse_sp stores the weight, the state variables and the
+   parameters in single precision, since the look-up tables are computed in
+   single precision anyway. The spike times stay in double precision and the
+   state variables are still allocated on the heap, so on 64-bit systems the
+   synapse takes 120 instead of 152 bytes, plus 4 instead of 8 bytes per state
+   variable (exponent+2 of them) and the overhead of the allocation.
 
   References:
    [1] Luque N. R., Garrido J. A., Carrillo R. R., Coenen O. J. Ros, E. (2011a). Cerebellarlike
@@ -44,26 +55,31 @@
 #include "common_synapse_properties.h"
 
 #include "connection.h"
+#include "kernel_manager.h"
 #include "archiving_node_cs.h"
 
 #include "ExponentialTable.h"
 #include "TrigonometricTable.h"
 
+#include <algorithm>
+
 #define A 1.0f/2.0f
 
 namespace mynest
 {
 /**
  * Class representing an STDPSinConnection.
+ * realT is the type used to store the weight, the state variables and the
+ * parameters of the synapse (float for stdp_sin_synapse_sp).
  */
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT = double >
 class STDPSinConnection : public nest::Connection< targetidentifierT >
 {
 
-private:
+public:
+  // Coefficients of the expansion of sin^exponent (also used by stdp_sin_q16_synapse_e<N>)
   static float terms[11][11];
 
-public:
   typedef nest::CommonSynapseProperties CommonPropertiesType;
   typedef nest::Connection< targetidentifierT > ConnectionBase;
 
@@ -135,7 +151,12 @@ public:
     ConnTestDummyNode dummy_target;
     ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
 
-    ((Archiving_Node_CS *) (&t))->register_stdp_connection_cs( t_lastspike - get_delay() );
+    // Frozen synapses do not read the history of the target
+    if ( this->plastic_ )
+    {
+      ((Archiving_Node_CS *) (&t))->register_stdp_connection_cs( t_lastspike - get_delay() );
+    }
+    this->registered_ = this->plastic_;
   }
 
   void
@@ -146,33 +167,41 @@ public:
 
 private:
   // data members of each connection
-  double weight_;
-  std::vector<double> state_vars_;
+  realT weight_;
+  std::vector<realT> state_vars_;
   double t_last_update_;
 
   // This vars could be common, but state_vars has to be resized according to Exponent.
   // Remaining vars depends on Exponent too.
-  double Peak_;
+  realT Peak_;
   unsigned short int Exponent_;
-  double inv_tau_;
-  double factor_;
+  realT inv_tau_;
+  realT factor_;
   float * TermPointer_;
 
   // This vars could be also common, but this optimization might be performed as a future development.
-  double A_plus_;
-  double A_minus_;
-  double Wmin_;
-  double Wmax_;
+  realT A_plus_;
+  realT A_minus_;
+  realT Wmin_;
+  realT Wmax_;
 
   double t_lastspike;
 
+  // Whether the weight is updated by the learning rule
+  bool plastic_;
+
+  // Whether the synapse is registered in the history of the target. It is
+  // cleared by set_status when the plasticity is frozen, and set again by the
+  // next presynaptic spike when it is enabled.
+  bool registered_;
+
   void apply_state_change(double new_time);
 
-  double check_weight_boundaries(double weight);
+  realT check_weight_boundaries(realT weight);
 };
 
-template < typename targetidentifierT >
-float STDPSinConnection< targetidentifierT >::terms[11][11] =
+template < typename targetidentifierT, typename realT >
+float STDPSinConnection< targetidentifierT, realT >::terms[11][11] =
   {{1,0,0,0,0,0,0,0,0,0,0},
    {A,-A,0,0,0,0,0,0,0,0,0},
    {3.0f/2.0f*pow(A,2),-4.0f/2.0f*pow(A,2),1.0f/2.0f*pow(A,2),0,0,0,0,0,0,0,0},
@@ -190,8 +219,8 @@ float STDPSinConnection< targetidentifierT >::terms[11][11] =
 // Implementation of class STDPSinConnection.
 //
 
-template < typename targetidentifierT >
-STDPSinConnection< targetidentifierT >::STDPSinConnection()
+template < typename targetidentifierT, typename realT >
+STDPSinConnection< targetidentifierT, realT >::STDPSinConnection()
   : ConnectionBase(),
   weight_( 1.0 ),
   state_vars_( ),
@@ -202,18 +231,20 @@ STDPSinConnection< targetidentifierT >::STDPSinConnection()
   A_minus_( 1.0 ),
   Wmin_( 0.0 ),
   Wmax_( 200.0 ),
-  t_lastspike ( 0.0)
+  t_lastspike ( 0.0),
+  plastic_( true ),
+  registered_( false )
 {
-  this->state_vars_ = std::vector<double>(this->Exponent_+2);
+  this->state_vars_ = std::vector<realT>(this->Exponent_+2);
   inv_tau_ = atan((float) this->Exponent_)/Peak_;
   factor_ = 1.0f/(exp(-atan((float)this->Exponent_))*pow(sin(atan((float)this->Exponent_)),(int) this->Exponent_));
 
   unsigned int ExponenLine = this->Exponent_/2;
-  TermPointer_ = STDPSinConnection< targetidentifierT >::terms[ExponenLine];
+  TermPointer_ = STDPSinConnection< targetidentifierT, realT >::terms[ExponenLine];
 }
 
-template < typename targetidentifierT >
-STDPSinConnection< targetidentifierT >::STDPSinConnection( const STDPSinConnection& rhs )
+template < typename targetidentifierT, typename realT >
+STDPSinConnection< targetidentifierT, realT >::STDPSinConnection( const STDPSinConnection& rhs )
   : ConnectionBase( rhs )
   , weight_( rhs.weight_ )
   , state_vars_( rhs.state_vars_ )
@@ -227,14 +258,16 @@ STDPSinConnection< targetidentifierT >::STDPSinConnection( const STDPSinConnecti
   , Wmin_( rhs.Wmin_ )
   , Wmax_( rhs.Wmax_ )
   , t_lastspike (rhs.t_lastspike)
+  , plastic_( rhs.plastic_ )
+  , registered_( rhs.registered_ )
 {
   unsigned int ExponenLine = this->Exponent_/2;
-  TermPointer_ = STDPSinConnection< targetidentifierT >::terms[ExponenLine];
+  TermPointer_ = STDPSinConnection< targetidentifierT, realT >::terms[ExponenLine];
 }
 
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT >
 void
-STDPSinConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+STDPSinConnection< targetidentifierT, realT >::get_status( DictionaryDatum& d ) const
 {
 
   // base class properties, different for individual synapse
@@ -244,18 +277,20 @@ STDPSinConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
   def< double >( d, "Wmin", Wmin_ );
   def< double >( d, "Wmax", Wmax_ );
   def< double >( d, nest::names::weight, this->weight_ );
+  def< bool >( d, "plastic", this->plastic_ );
 
   def< double >( d, "peak", this->Peak_ );
   def< double >( d, "exponent", this->Exponent_ );
 }
 
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT >
 void
-STDPSinConnection< targetidentifierT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+STDPSinConnection< targetidentifierT, realT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
 {
   // base class properties
   ConnectionBase::set_status( d, cm );
   updateValue< double >( d, nest::names::weight, weight_ );
+  updateValue< bool >( d, "plastic", plastic_ );
 
   updateValue< double >( d, "A_plus", A_plus_ );
   updateValue< double >( d, "A_minus", A_minus_ );
@@ -278,7 +313,7 @@ STDPSinConnection< targetidentifierT >::set_status( const DictionaryDatum& d, ne
     this->Exponent_ = (unsigned short int) expon;
 
     unsigned int ExponenLine = Exponent_/2;
-    TermPointer_ = STDPSinConnection< targetidentifierT >::terms[ExponenLine];
+    TermPointer_ = STDPSinConnection< targetidentifierT, realT >::terms[ExponenLine];
 
     this->state_vars_.resize(this->Exponent_+2);
   }
@@ -289,28 +324,39 @@ STDPSinConnection< targetidentifierT >::set_status( const DictionaryDatum& d, ne
 
   this->inv_tau_ = atan((float) this->Exponent_)/this->Peak_;
   this->factor_ = 1.0f/(exp(-atan((float)this->Exponent_))*pow(sin(atan((float)this->Exponent_)),(int) this->Exponent_));
+
+  // The target stops keeping the history for this synapse as soon as it is
+  // frozen. Only connected synapses are registered, not the default
+  // connection changed by SetDefaults, whose value is copied to the new
+  // connections and checked in check_connection.
+  if ( !this->plastic_ && this->registered_ )
+  {
+    nest::Node* target = get_target( get_connection_thread( this->get_syn_id(), cm ) );
+    static_cast< Archiving_Node_CS* >( target )->unregister_stdp_connection_cs( this->t_last_update_ );
+    this->registered_ = false;
+  }
 }
 
-template < typename targetidentifierT >
-void STDPSinConnection< targetidentifierT >::apply_state_change(double new_time){
+template < typename targetidentifierT, typename realT >
+void STDPSinConnection< targetidentifierT, realT >::apply_state_change(double new_time){
 
   // Evolve all the state variables from last_cs_time until t_cs
-  double OldExpon = this->state_vars_[1];
+  realT OldExpon = this->state_vars_[1];
 
   double ElapsedTime = double(new_time - this->t_last_update_);
-  double ElapsedRelative = ElapsedTime*this->inv_tau_;
+  realT ElapsedRelative = ElapsedTime*this->inv_tau_;
 
-  double expon = ExponentialTable::GetResult(-ElapsedRelative);
+  realT expon = ExponentialTable::GetResult(-ElapsedRelative);
 
   this->t_last_update_ = new_time;
 
-  double NewExpon = OldExpon * expon;
-  double NewActivity =NewExpon*this->TermPointer_[0];
+  realT NewExpon = OldExpon * expon;
+  realT NewActivity =NewExpon*this->TermPointer_[0];
 
   int aux=TrigonometricTable::CalculateOffsetPosition(2*ElapsedRelative);
   int LUTindex=0;
 
-  double SinVar, CosVar, OldVarCos, OldVarSin, NewVarCos, NewVarSin;
+  realT SinVar, CosVar, OldVarCos, OldVarSin, NewVarCos, NewVarSin;
   int grade, offset;
   for (grade=2, offset=1; grade<=this->Exponent_; grade+=2, offset++){
 
@@ -341,9 +387,9 @@ void STDPSinConnection< targetidentifierT >::apply_state_change(double new_time)
  * \param p The port under which this connection is stored in the Connector.
  * \param t_lastspike Time point of last spike emitted
  */
-template < typename targetidentifierT >
+template < typename targetidentifierT, typename realT >
 inline void
-STDPSinConnection< targetidentifierT >::send( nest::Event& e,
+STDPSinConnection< targetidentifierT, realT >::send( nest::Event& e,
   nest::thread t,
   const nest::CommonSynapseProperties& )
 {
@@ -351,15 +397,46 @@ STDPSinConnection< targetidentifierT >::send( nest::Event& e,
 
   //std::cout << "Synapse parameters: Aplus: " << this->A_plus_ << ". Aminus: " << this->A_minus_ << ". Wmin: " << this->Wmin_ << ". Wmax: " << this->Wmax_ << ". Expon: " << this->Exponent_ << ". Peak: " << this->Peak_ << ". Weight: " << this->weight_ << std::endl;
 
-  nest::Node* target = get_target( t );
+  // Resolve the target only once, since with TargetIdentifierIndex (the _hpc
+  // models) it is looked up from its thread-local index
+  mynest::Archiving_Node_CS* target = static_cast< mynest::Archiving_Node_CS* >( get_target( t ) );
 
   // purely dendritic delay
   //float dendritic_delay = get_delay();
-  double t_spike = e.get_stamp().get_ms();
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
 
   //std::cout << "Processing PF spike at time " << t_spike << std::endl;
 
-  if (this->t_last_update_>0.0){
+  if ( !this->plastic_ )
+  {
+    // Plasticity is frozen: deliver the spike as a static synapse
+    e.set_receiver( *target );
+    e.set_weight( weight_ );
+    e.set_delay_steps( get_delay_steps() );
+    e.set_rport( get_rport() );
+    e();
+
+    t_lastspike = t_spike;
+    return;
+  }
+
+  // LTP is only due if the previous presynaptic spike was processed by the learning rule
+  bool apply_ltp = this->t_last_update_>0.0;
+
+  if ( !this->registered_ )
+  {
+    // Plasticity has been enabled again: the learning rule restarts from
+    // this spike, ignoring the activity while it was frozen
+    target->register_stdp_connection_cs( t_spike );
+    this->registered_ = true;
+
+    std::fill( this->state_vars_.begin(), this->state_vars_.end(), 0.0 );
+    this->t_last_update_ = t_spike;
+    apply_ltp = false;
+  }
+
+  if (apply_ltp){
     // Apply the LTP due to the previous presynaptic spike
     this->weight_ += this->A_plus_;
 
@@ -374,20 +451,20 @@ STDPSinConnection< targetidentifierT >::send( nest::Event& e,
   std::deque<mynest::histentry_cs>::iterator start;
   std::deque<mynest::histentry_cs>::iterator finish;
   //((mynest::Archiving_Node_Sym *)target_)->get_sym_history(t_lastspike - dendritic_delay, t_spike - dendritic_delay,&start, &finish);
-  ((mynest::Archiving_Node_CS *)target)->get_cs_history(this->t_last_update_, t_spike,&start, &finish);
+  target->get_cs_history(this->t_last_update_, t_spike,&start, &finish);
   //weight change due to post-synaptic spikes since last pre-synaptic spike
   while (start != finish){
 
      // Evolve the state variables until the CS spike time
-     this->apply_state_change(start->t_);
+     this->apply_state_change(target->get_cs_time( *start ));
 
      // Update the synaptic weight due to CS
-     this->weight_ -= this->A_minus_*this->state_vars_[0];
+     this->weight_ -= this->A_minus_*start->multiplicity_*this->state_vars_[0];
 
      // Check wether the weight stays within the boundaries
      this->weight_ = this->check_weight_boundaries(this->weight_);
 
-     //std::cout << "Applying LTD with spike at time: " << start->t_ << ". New weight: " << this->weight_ << std::endl;
+     //std::cout << "Applying LTD with spike at time: " << target->get_cs_time( *start ) << ". New weight: " << this->weight_ << std::endl;
 
      ++start;
   }
@@ -412,8 +489,8 @@ STDPSinConnection< targetidentifierT >::send( nest::Event& e,
 
 }
 
-template < typename targetidentifierT >
-inline double STDPSinConnection< targetidentifierT >::check_weight_boundaries(double weight){
+template < typename targetidentifierT, typename realT >
+inline realT STDPSinConnection< targetidentifierT, realT >::check_weight_boundaries(realT weight){
   if (weight_ > this->Wmax_){
     return this->Wmax_;
   } else if (weight < this->Wmin_) {
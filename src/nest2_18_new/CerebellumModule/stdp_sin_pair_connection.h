@@ -0,0 +1,423 @@
+/*
+ *  stdp_sin_pair_connection.h
+ */
+
+#ifndef STDP_SIN_PAIR_CONNECTION_H
+#define STDP_SIN_PAIR_CONNECTION_H
+
+/* BeginDocumentation
+
+   Name: stdp_sin_pair_synapse - Synapse type for complex-spike-driven
+   spike-timing dependent plasticity evaluated on spike pairs.
+
+   Description:
+   stdp_sin_pair_synapse implements the same learning rule as stdp_sin_synapse,
+   but instead of evolving the state variables of the sin^exponent expansion it
+   stores the times of the last presynaptic spikes. Every time the complex spike
+   generates an spike, the LTD is computed by adding up the kernel
+   f(t) = exp(-t/tau_c)*sin(t/tau_c)^exponent for the stored spikes, read from
+   a look-up table shared by all synapses with the same exponent and peak.
+
+   Only the last four presynaptic spikes are considered, so this model is
+   equivalent to stdp_sin_synapse as long as older spikes fall outside the
+   kernel, i.e. for sparse presynaptic activity (below 1 Hz for a peak of
+   100 ms). For dense activity stdp_sin_synapse should be used.
+
+   The learning rule parameters and the kernel table are common properties
+   of the model, so that every synapse only stores its weight and the times
+   of its last spikes. They are set with SetDefaults or CopyModel, and cannot
+   be given to Connect or to a single connection.
+
+   Parameters:
+      A_plus    double - Amplitude of weight change for facilitation
+      A_minus   double - Amplitude of weight change for depression
+      Wmin      double - Minimal synaptic weight
+      Wmax      double - Maximal synaptic weight
+      exponent  unsigned int - Exponent of the sin function (even integer between 2 and 20). The lower the exponent the wider the kernel function.
+      peak      double - Time (in ms) of the peak of the kernel function (typically 100ms for the cerebellar parallel fibers).
+
+   Transmits: SpikeEvent
+
+   SeeAlso: stdp_sin_synapse, iaf_cond_exp_cs
+*/
+
+#include "common_synapse_properties.h"
+
+#include "connection.h"
+#include "archiving_node_cs.h"
+
+#include "KernelTable.h"
+#include "common_properties_check.h"
+
+#include <limits>
+
+namespace mynest
+{
+
+/**
+ * Class containing the common properties for all synapses of type
+ * STDPSinPairConnection, including the tabulated kernel.
+ */
+class STDPSinPairCommonProperties : public nest::CommonSynapseProperties
+{
+
+public:
+  /**
+   * Default constructor.
+   * Sets all property values to defaults.
+   */
+  STDPSinPairCommonProperties();
+
+  /**
+   * Get all properties and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  double check_weight_boundaries( double weight ) const;
+
+  // Tabulated kernel shared by all the synapses with the same exponent and peak
+  const KernelTable* kernel_;
+
+  double Peak_;
+  unsigned short int Exponent_;
+
+  double A_plus_;
+  double A_minus_;
+  double Wmin_;
+  double Wmax_;
+};
+
+inline
+STDPSinPairCommonProperties::STDPSinPairCommonProperties()
+  : nest::CommonSynapseProperties()
+  , Peak_( 100.0 )
+  , Exponent_( 2 )
+  , A_plus_( 1.0 )
+  , A_minus_( 1.0 )
+  , Wmin_( 0.0 )
+  , Wmax_( 200.0 )
+{
+  kernel_ = KernelTable::GetSinKernel( Exponent_, Peak_ );
+}
+
+inline void
+STDPSinPairCommonProperties::get_status( DictionaryDatum& d ) const
+{
+  nest::CommonSynapseProperties::get_status( d );
+
+  def< double >( d, "A_plus", A_plus_ );
+  def< double >( d, "A_minus", A_minus_ );
+  def< double >( d, "Wmin", Wmin_ );
+  def< double >( d, "Wmax", Wmax_ );
+  def< double >( d, "peak", this->Peak_ );
+  def< double >( d, "exponent", this->Exponent_ );
+}
+
+inline void
+STDPSinPairCommonProperties::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  nest::CommonSynapseProperties::set_status( d, cm );
+
+  updateValue< double >( d, "A_plus", A_plus_ );
+  updateValue< double >( d, "A_minus", A_minus_ );
+
+  updateValue< double >( d, "Wmin", Wmin_ );
+  updateValue< double >( d, "Wmax", Wmax_ );
+
+  double expon = this->Exponent_;
+  double new_peak = this->Peak_;
+  updateValue< double >( d, "exponent", expon );
+  updateValue< double >( d, "peak", new_peak );
+
+  double intpart;
+  if ( modf( expon, &intpart ) != 0.0 || expon < 2 || expon > 20 || ( ( long ) expon ) % 2 != 0 )
+  {
+    throw nest::BadProperty( "STDP sin exponent must be an even integer between 2 and 20" );
+  }
+
+  if ( new_peak <= 0.0 )
+  {
+    throw nest::BadProperty( "STDP sin peak must be strictly positive." );
+  }
+
+  if ( ( unsigned short int ) expon != this->Exponent_ || new_peak != this->Peak_ )
+  {
+    this->Exponent_ = ( unsigned short int ) expon;
+    this->Peak_ = new_peak;
+    this->kernel_ = KernelTable::GetSinKernel( this->Exponent_, this->Peak_ );
+  }
+}
+
+inline double
+STDPSinPairCommonProperties::check_weight_boundaries( double weight ) const
+{
+  if (weight > this->Wmax_){
+    return this->Wmax_;
+  } else if (weight < this->Wmin_) {
+    return this->Wmin_;
+  }
+
+  return weight;
+}
+
+
+/**
+ * Class representing an STDPSinPairConnection.
+ */
+template < typename targetidentifierT >
+class STDPSinPairConnection : public nest::Connection< targetidentifierT >
+{
+
+public:
+  typedef STDPSinPairCommonProperties CommonPropertiesType;
+  typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+  /**
+   * Number of presynaptic spikes stored by each synapse.
+   */
+  static const unsigned int N_PAIR_SPIKES = 4;
+
+  /**
+   * Default Constructor.
+   * Sets default values for all parameters. Needed by GenericConnectorModel.
+   */
+  STDPSinPairConnection();
+
+  /**
+   * Copy constructor from a property object.
+   * Needs to be defined properly in order for GenericConnector to work.
+   */
+  STDPSinPairConnection( const STDPSinPairConnection& );
+
+  // Explicitly declare all methods inherited from the dependent base ConnectionBase.
+  // This avoids explicit name prefixes in all places these functions are used.
+  // Since ConnectionBase depends on the template parameter, they are not automatically
+  // found in the base class.
+  using ConnectionBase::get_delay;
+  using ConnectionBase::get_delay_steps;
+  using ConnectionBase::get_rport;
+  using ConnectionBase::get_target;
+
+  /**
+   * Get all properties of this connection and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties of this connection from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Send an event to the receiver of this connection.
+   * \param e The event to send
+   */
+  void send( nest::Event& e, nest::thread t, const CommonPropertiesType& cp );
+
+  class ConnTestDummyNode : public nest::ConnTestDummyNodeBase
+  {
+  public:
+    // Ensure proper overriding of overloaded virtual functions.
+    // Return values from functions are ignored.
+    using ConnTestDummyNodeBase::handles_test_event;
+    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+    {
+      return nest::invalid_port_;
+    }
+  };
+
+  /*
+   * This function calls check_connection on the sender and checks if the receiver
+   * accepts the event type and receptor type requested by the sender.
+   * Node::check_connection() will either confirm the receiver port by returning
+   * true or false if the connection should be ignored.
+   *
+   * \param s The source node
+   * \param r The target node
+   * \param receptor_type The ID of the requested receptor type
+   */
+  void
+  check_connection( nest::Node& s,
+    nest::Node& t,
+    nest::rport receptor_type,
+    const CommonPropertiesType& cp )
+  {
+    ConnTestDummyNode dummy_target;
+    ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+    ((Archiving_Node_CS *) (&t))->register_stdp_connection_cs( t_last_update_ - get_delay() );
+  }
+
+  /**
+   * The learning rule parameters are common properties, so they cannot be
+   * set for individual connections.
+   */
+  void check_synapse_params( const DictionaryDatum& syn_spec ) const;
+
+  void
+  set_weight( double w )
+  {
+    weight_ = w;
+  }
+
+private:
+  // data members of each connection
+  double weight_;
+
+  // Time of the last presynaptic spike (in ms)
+  double t_last_update_;
+
+  // Age of the last presynaptic spikes with respect to t_last_update_ (in ms).
+  // Empty positions are marked with an infinite age.
+  float pair_ages_[ N_PAIR_SPIKES ];
+
+  double get_pair_activity( double t, const CommonPropertiesType& cp ) const;
+};
+
+//
+// Implementation of class STDPSinPairConnection.
+//
+
+template < typename targetidentifierT >
+STDPSinPairConnection< targetidentifierT >::STDPSinPairConnection()
+  : ConnectionBase(),
+  weight_( 1.0 ),
+  t_last_update_( 0.0 )
+{
+  for ( unsigned int i = 0; i < N_PAIR_SPIKES; ++i )
+  {
+    pair_ages_[ i ] = std::numeric_limits< float >::infinity();
+  }
+}
+
+template < typename targetidentifierT >
+STDPSinPairConnection< targetidentifierT >::STDPSinPairConnection( const STDPSinPairConnection& rhs )
+  : ConnectionBase( rhs )
+  , weight_( rhs.weight_ )
+  , t_last_update_( rhs.t_last_update_ )
+{
+  for ( unsigned int i = 0; i < N_PAIR_SPIKES; ++i )
+  {
+    pair_ages_[ i ] = rhs.pair_ages_[ i ];
+  }
+}
+
+template < typename targetidentifierT >
+void
+STDPSinPairConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+{
+  // base class properties, different for individual synapse
+  ConnectionBase::get_status( d );
+  def< double >( d, nest::names::weight, this->weight_ );
+}
+
+template < typename targetidentifierT >
+void
+STDPSinPairConnection< targetidentifierT >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  // The common properties are also passed here by SetDefaults, so only
+  // values different from the current ones are rejected
+  const CommonPropertiesType& cp = static_cast< const CommonPropertiesType& >( cm.get_common_properties() );
+  check_common_property( d, "A_plus", cp.A_plus_, "stdp_sin_pair_synapse" );
+  check_common_property( d, "A_minus", cp.A_minus_, "stdp_sin_pair_synapse" );
+  check_common_property( d, "Wmin", cp.Wmin_, "stdp_sin_pair_synapse" );
+  check_common_property( d, "Wmax", cp.Wmax_, "stdp_sin_pair_synapse" );
+  check_common_property( d, "exponent", cp.Exponent_, "stdp_sin_pair_synapse" );
+  check_common_property( d, "peak", cp.Peak_, "stdp_sin_pair_synapse" );
+
+  // base class properties
+  ConnectionBase::set_status( d, cm );
+  updateValue< double >( d, nest::names::weight, weight_ );
+}
+
+template < typename targetidentifierT >
+void
+STDPSinPairConnection< targetidentifierT >::check_synapse_params( const DictionaryDatum& syn_spec ) const
+{
+  const std::string param_arr[] = { "A_plus", "A_minus", "Wmin", "Wmax", "exponent", "peak" };
+  check_no_common_properties( syn_spec, param_arr, sizeof( param_arr ) / sizeof( std::string ), "stdp_sin_pair_synapse" );
+}
+
+/**
+ * Value of the kernel activity at time t, obtained by adding up the kernel for
+ * the stored presynaptic spikes. t must not be earlier than t_last_update_.
+ */
+template < typename targetidentifierT >
+inline double
+STDPSinPairConnection< targetidentifierT >::get_pair_activity( double t, const CommonPropertiesType& cp ) const
+{
+  const double ElapsedTime = t - this->t_last_update_;
+
+  double activity = 0.0;
+  for ( unsigned int i = 0; i < N_PAIR_SPIKES; ++i )
+  {
+    activity += cp.kernel_->GetResult( ElapsedTime + this->pair_ages_[ i ] );
+  }
+
+  return activity;
+}
+
+/**
+ * Send an event to the receiver of this connection.
+ * \param e The event to send
+ * \param p The port under which this connection is stored in the Connector.
+ */
+template < typename targetidentifierT >
+inline void
+STDPSinPairConnection< targetidentifierT >::send( nest::Event& e,
+  nest::thread t,
+  const CommonPropertiesType& cp )
+{
+  nest::Node* target = get_target( t );
+
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
+
+  if (this->t_last_update_>0.0){
+    // Apply the LTP due to the previous presynaptic spike
+    this->weight_ += cp.A_plus_;
+
+    // Check wether the weight stays within the boundaries
+    this->weight_ = cp.check_weight_boundaries(this->weight_);
+  }
+
+  std::deque<mynest::histentry_cs>::iterator start;
+  std::deque<mynest::histentry_cs>::iterator finish;
+  ((mynest::Archiving_Node_CS *)target)->get_cs_history(this->t_last_update_, t_spike,&start, &finish);
+  //weight change due to post-synaptic spikes since last pre-synaptic spike
+  while (start != finish){
+
+     // Update the synaptic weight due to CS
+     this->weight_ -= cp.A_minus_*start->multiplicity_*this->get_pair_activity( ((mynest::Archiving_Node_CS *)target)->get_cs_time( *start ), cp );
+
+     // Check wether the weight stays within the boundaries
+     this->weight_ = cp.check_weight_boundaries(this->weight_);
+
+     ++start;
+  }
+
+  // Store the incoming spike, dropping the oldest one
+  const float ElapsedTime = t_spike - this->t_last_update_;
+  for ( unsigned int i = N_PAIR_SPIKES - 1; i > 0; --i )
+  {
+    this->pair_ages_[ i ] = this->pair_ages_[ i - 1 ] + ElapsedTime;
+  }
+  this->pair_ages_[ 0 ] = 0.0f;
+
+  this->t_last_update_ = t_spike;
+
+  e.set_receiver( *target );
+  e.set_weight( weight_ );
+  e.set_delay_steps( get_delay_steps() );
+  e.set_rport( get_rport() );
+  e();
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef STDP_SIN_PAIR_CONNECTION_H
@@ -0,0 +1,442 @@
+/*
+ *  stdp_sin_q16_connection.h
+ */
+
+#ifndef STDP_SIN_Q16_CONNECTION_H
+#define STDP_SIN_Q16_CONNECTION_H
+
+/* BeginDocumentation
+
+   Name: stdp_sin_q16_synapse_e<N> - Synapse types for complex-spike-driven
+   spike-timing dependent plasticity with 16-bit weights.
+
+   Description:
+   stdp_sin_q16_synapse_e2, stdp_sin_q16_synapse_e4, ...,
+   stdp_sin_q16_synapse_e20 implement the same learning rule as
+   stdp_sin_synapse with the exponent of their name, but the weight is
+   stored as a 16-bit fixed point value between Wmin and Wmax, and the state
+   variables in single precision. The parameters of the learning rule are
+   common properties, and they can only be set with SetDefaults or CopyModel.
+
+   After every presynaptic spike the updated weight is rounded to the nearest
+   representable value, or stochastically if stochastic_rounding is true.
+   The stochastic rounding draws its random numbers from a counter-based
+   generator keyed by the source, the target, the spike step and rng_seed,
+   so the weights do not depend on the number of threads or processes.
+   The resolution of the weight is (Wmax-Wmin)/65535. The exponent sets the
+   number of state variables, exponent+2, which are stored inline in the
+   synapse. Each exponent is a separate model so that every synapse only
+   stores the state variables of its exponent.
+
+   Common properties:
+      A_plus    double - Amplitude of weight change for facilitation
+      A_minus   double - Amplitude of weight change for depression
+      Wmin      double - Minimal synaptic weight
+      Wmax      double - Maximal synaptic weight
+      exponent  unsigned int - Exponent of the sin function, fixed by the model (read only). The lower the exponent the wider the kernel function.
+      peak      double - Time (in ms) of the peak of the kernel function (typically 100ms for the cerebellar parallel fibers).
+      stochastic_rounding  bool - Round the weight updates stochastically (default true)
+      rng_seed  int    - Seed of the stochastic rounding (default 0)
+
+   Transmits: SpikeEvent
+
+   Remarks:
+   - Wmin and Wmax can only be set before creating the connections, and
+     together with the default weight, which is stored in their range.
+
+   SeeAlso: stdp_sin_synapse, iaf_cond_exp_cs
+*/
+
+#include "connection.h"
+#include "target_identifier.h"
+#include "archiving_node_cs.h"
+
+#include "common_properties_check.h"
+#include "stdp_q16_common_properties.h"
+#include "stdp_sin_connection.h"
+
+#include "ExponentialTable.h"
+#include "TrigonometricTable.h"
+
+#include <algorithm>
+
+namespace mynest
+{
+
+/**
+ * Class containing the common properties for all synapses of type
+ * STDPSinQ16Connection with exponent exponentV.
+ */
+template < unsigned int exponentV >
+class STDPSinQ16CommonProperties : public STDPQ16CommonProperties
+{
+
+public:
+  /**
+   * Default constructor.
+   * Sets all property values to defaults.
+   */
+  STDPSinQ16CommonProperties();
+
+  /**
+   * Get all properties and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Exponent of the sin function.
+   */
+  static const unsigned int Exponent_ = exponentV;
+
+  double Peak_;
+  double inv_tau_;
+  double factor_;
+  const float * TermPointer_;
+
+private:
+  void update_kernel();
+};
+
+template < unsigned int exponentV >
+STDPSinQ16CommonProperties< exponentV >::STDPSinQ16CommonProperties()
+  : STDPQ16CommonProperties()
+  , Peak_( 100.0 )
+{
+  this->update_kernel();
+}
+
+template < unsigned int exponentV >
+void
+STDPSinQ16CommonProperties< exponentV >::update_kernel()
+{
+  this->inv_tau_ = atan((float) this->Exponent_)/this->Peak_;
+  this->factor_ = 1.0f/(exp(-atan((float)this->Exponent_))*pow(sin(atan((float)this->Exponent_)),(int) this->Exponent_));
+
+  unsigned int ExponenLine = this->Exponent_/2;
+  this->TermPointer_ = STDPSinConnection< nest::TargetIdentifierPtrRport >::terms[ExponenLine];
+}
+
+template < unsigned int exponentV >
+void
+STDPSinQ16CommonProperties< exponentV >::get_status( DictionaryDatum& d ) const
+{
+  STDPQ16CommonProperties::get_status( d );
+
+  def< double >( d, "peak", this->Peak_ );
+  def< double >( d, "exponent", this->Exponent_ );
+}
+
+template < unsigned int exponentV >
+void
+STDPSinQ16CommonProperties< exponentV >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  STDPQ16CommonProperties::set_status( d, cm );
+
+  double expon = this->Exponent_;
+  double new_peak = this->Peak_;
+  updateValue< double >( d, "exponent", expon );
+  updateValue< double >( d, "peak", new_peak );
+
+  if ( expon != this->Exponent_ )
+  {
+    throw nest::BadProperty( "The exponent is fixed by the model; use the stdp_sin_q16_synapse_e<N> model of exponent N." );
+  }
+
+  if ( new_peak <= 0.0 )
+  {
+    throw nest::BadProperty( "STDP sin peak must be strictly positive." );
+  }
+
+  this->Peak_ = new_peak;
+  this->update_kernel();
+}
+
+
+/**
+ * Class representing an STDPSinQ16Connection.
+ * exponentV is the exponent of the sin function, an even integer between 2
+ * and 20, which sets the number of state variables of the synapse.
+ */
+template < typename targetidentifierT, unsigned int exponentV >
+class STDPSinQ16Connection : public nest::Connection< targetidentifierT >
+{
+
+public:
+  typedef STDPSinQ16CommonProperties< exponentV > CommonPropertiesType;
+  typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+  /**
+   * Default Constructor.
+   * Sets default values for all parameters. Needed by GenericConnectorModel.
+   */
+  STDPSinQ16Connection();
+
+  /**
+   * Copy constructor from a property object.
+   * Needs to be defined properly in order for GenericConnector to work.
+   */
+  STDPSinQ16Connection( const STDPSinQ16Connection& );
+
+  // Explicitly declare all methods inherited from the dependent base ConnectionBase.
+  // This avoids explicit name prefixes in all places these functions are used.
+  // Since ConnectionBase depends on the template parameter, they are not automatically
+  // found in the base class.
+  using ConnectionBase::get_delay;
+  using ConnectionBase::get_delay_steps;
+  using ConnectionBase::get_rport;
+  using ConnectionBase::get_syn_id;
+  using ConnectionBase::get_target;
+
+  /**
+   * Get all properties of this connection and put them into a dictionary.
+   */
+  void get_status( DictionaryDatum& d ) const;
+
+  /**
+   * Set properties of this connection from the values given in dictionary.
+   */
+  void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+  /**
+   * Send an event to the receiver of this connection.
+   * \param e The event to send
+   */
+  void send( nest::Event& e, nest::thread t, const CommonPropertiesType& cp );
+
+  class ConnTestDummyNode : public nest::ConnTestDummyNodeBase
+  {
+  public:
+    // Ensure proper overriding of overloaded virtual functions.
+    // Return values from functions are ignored.
+    using ConnTestDummyNodeBase::handles_test_event;
+    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+    {
+      return nest::invalid_port_;
+    }
+  };
+
+  /*
+   * This function calls check_connection on the sender and checks if the receiver
+   * accepts the event type and receptor type requested by the sender.
+   * Node::check_connection() will either confirm the receiver port by returning
+   * true or false if the connection should be ignored.
+   *
+   * \param s The source node
+   * \param r The target node
+   * \param receptor_type The ID of the requested receptor type
+   */
+  void
+  check_connection( nest::Node& s,
+    nest::Node& t,
+    nest::rport receptor_type,
+    const CommonPropertiesType& cp )
+  {
+    ConnTestDummyNode dummy_target;
+    ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+    ((Archiving_Node_CS *) (&t))->register_stdp_connection_cs( t_last_update_ - get_delay() );
+  }
+
+  /**
+   * The learning rule parameters are common properties, so they cannot be
+   * set for individual connections.
+   */
+  void
+  check_synapse_params( const DictionaryDatum& syn_spec ) const
+  {
+    const std::string param_arr[] = { "A_plus", "A_minus", "Wmin", "Wmax", "stochastic_rounding", "rng_seed", "exponent", "peak" };
+    check_no_common_properties( syn_spec, param_arr, sizeof( param_arr ) / sizeof( std::string ), "stdp_sin_q16_synapse_e<N>" );
+  }
+
+  void
+  set_weight( double w )
+  {
+    weight_ = get_q16_common_properties< CommonPropertiesType >( get_syn_id() ).quantize_weight( w );
+  }
+
+private:
+  // data members of each connection
+  unsigned short int weight_;
+
+  // Kernel activity, exponential term, and cos/sin terms of every even grade
+  float state_vars_[ exponentV + 2 ];
+
+  double t_last_update_;
+
+  void apply_state_change(double new_time, const CommonPropertiesType& cp);
+};
+
+//
+// Implementation of class STDPSinQ16Connection.
+//
+
+template < typename targetidentifierT, unsigned int exponentV >
+STDPSinQ16Connection< targetidentifierT, exponentV >::STDPSinQ16Connection()
+  : ConnectionBase(),
+  weight_( CommonPropertiesType().quantize_weight( 1.0 ) ),
+  t_last_update_( 0.0 )
+{
+  std::fill( this->state_vars_, this->state_vars_ + exponentV + 2, 0.0f );
+}
+
+template < typename targetidentifierT, unsigned int exponentV >
+STDPSinQ16Connection< targetidentifierT, exponentV >::STDPSinQ16Connection( const STDPSinQ16Connection& rhs )
+  : ConnectionBase( rhs )
+  , weight_( rhs.weight_ )
+  , t_last_update_( rhs.t_last_update_ )
+{
+  std::copy( rhs.state_vars_, rhs.state_vars_ + exponentV + 2, this->state_vars_ );
+}
+
+template < typename targetidentifierT, unsigned int exponentV >
+void
+STDPSinQ16Connection< targetidentifierT, exponentV >::get_status( DictionaryDatum& d ) const
+{
+  // base class properties, different for individual synapse
+  ConnectionBase::get_status( d );
+  def< double >( d, nest::names::weight,
+    get_q16_common_properties< CommonPropertiesType >( get_syn_id() ).get_weight( this->weight_ ) );
+}
+
+template < typename targetidentifierT, unsigned int exponentV >
+void
+STDPSinQ16Connection< targetidentifierT, exponentV >::set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+{
+  // The common properties are also passed here by SetDefaults, so only
+  // values different from the current ones are rejected
+  const CommonPropertiesType& cp = static_cast< const CommonPropertiesType& >( cm.get_common_properties() );
+  check_common_property( d, "A_plus", cp.A_plus_, "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "A_minus", cp.A_minus_, "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "Wmin", cp.Wmin_, "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "Wmax", cp.Wmax_, "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "stochastic_rounding", cp.stochastic_rounding_, "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "rng_seed", cp.rng_seed_, "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "exponent", double( cp.Exponent_ ), "stdp_sin_q16_synapse_e<N>" );
+  check_common_property( d, "peak", cp.Peak_, "stdp_sin_q16_synapse_e<N>" );
+
+  // base class properties
+  ConnectionBase::set_status( d, cm );
+
+  double weight;
+  if ( updateValue< double >( d, nest::names::weight, weight ) )
+  {
+    this->weight_ = cp.quantize_weight( weight );
+  }
+}
+
+template < typename targetidentifierT, unsigned int exponentV >
+void STDPSinQ16Connection< targetidentifierT, exponentV >::apply_state_change(double new_time, const CommonPropertiesType& cp){
+
+  // Evolve all the state variables from last_cs_time until t_cs
+  float OldExpon = this->state_vars_[1];
+
+  double ElapsedTime = double(new_time - this->t_last_update_);
+  float ElapsedRelative = ElapsedTime*cp.inv_tau_;
+
+  float expon = ExponentialTable::GetResult(-ElapsedRelative);
+
+  this->t_last_update_ = new_time;
+
+  float NewExpon = OldExpon * expon;
+  float NewActivity =NewExpon*cp.TermPointer_[0];
+
+  int aux=TrigonometricTable::CalculateOffsetPosition(2*ElapsedRelative);
+  int LUTindex=0;
+
+  float SinVar, CosVar, OldVarCos, OldVarSin, NewVarCos, NewVarSin;
+  int grade, offset;
+  for (grade=2, offset=1; grade<=exponentV; grade+=2, offset++){
+
+    LUTindex =TrigonometricTable::CalculateValidPosition(LUTindex,aux);
+
+    OldVarCos = this->state_vars_[grade];
+    OldVarSin = this->state_vars_[grade + 1];
+
+    SinVar = TrigonometricTable::GetElement(LUTindex);
+    CosVar = TrigonometricTable::GetElement(LUTindex+1);
+
+    NewVarCos = (OldVarCos*CosVar-OldVarSin*SinVar)*expon;
+    NewVarSin = (OldVarSin*CosVar+OldVarCos*SinVar)*expon;
+
+    NewActivity+= NewVarCos*cp.TermPointer_[offset];
+
+    this->state_vars_[grade] = NewVarCos;
+    this->state_vars_[grade+1] = NewVarSin;
+  }
+  NewActivity*=cp.factor_;
+  this->state_vars_[0] = NewActivity;
+  this->state_vars_[1] = NewExpon;
+}
+
+/**
+ * Send an event to the receiver of this connection.
+ * \param e The event to send
+ * \param p The port under which this connection is stored in the Connector.
+ */
+template < typename targetidentifierT, unsigned int exponentV >
+inline void
+STDPSinQ16Connection< targetidentifierT, exponentV >::send( nest::Event& e,
+  nest::thread t,
+  const CommonPropertiesType& cp )
+{
+  nest::Node* target = get_target( t );
+
+  // Precise spike time, e.get_offset() is 0 for on-grid spikes
+  double t_spike = e.get_stamp().get_ms() - e.get_offset();
+
+  // The weight is updated in double precision and rounded once per spike
+  double weight = cp.get_weight( this->weight_ );
+
+  if (this->t_last_update_>0.0){
+    // Apply the LTP due to the previous presynaptic spike
+    weight += cp.A_plus_;
+
+    // Check wether the weight stays within the boundaries
+    weight = cp.check_weight_boundaries(weight);
+  }
+
+  std::deque<mynest::histentry_cs>::iterator start;
+  std::deque<mynest::histentry_cs>::iterator finish;
+  ((mynest::Archiving_Node_CS *)target)->get_cs_history(this->t_last_update_, t_spike,&start, &finish);
+  //weight change due to post-synaptic spikes since last pre-synaptic spike
+  while (start != finish){
+
+     // Evolve the state variables until the CS spike time
+     this->apply_state_change(((mynest::Archiving_Node_CS *)target)->get_cs_time( *start ), cp);
+
+     // Update the synaptic weight due to CS
+     weight -= cp.A_minus_*start->multiplicity_*this->state_vars_[0];
+
+     // Check wether the weight stays within the boundaries
+     weight = cp.check_weight_boundaries(weight);
+
+     ++start;
+  }
+
+  // Evolve the state variables until the presynaptic spike time
+  this->apply_state_change(t_spike, cp);
+
+  // -----------------------------------
+  // Add the effect of the presynaptic spike to the state vars
+  this->state_vars_[1] += 1.0f;
+  for (unsigned int grade=2; grade<=exponentV; grade+=2){
+    this->state_vars_[grade] += 1.0f;
+  }
+
+  this->weight_ = cp.quantize_weight( weight, e.get_sender_gid(), target->get_gid(), e.get_stamp().get_steps() );
+
+  e.set_receiver( *target );
+  e.set_weight( cp.get_weight( this->weight_ ) );
+  e.set_delay_steps( get_delay_steps() );
+  e.set_rport( get_rport() );
+  e();
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef STDP_SIN_Q16_CONNECTION_H
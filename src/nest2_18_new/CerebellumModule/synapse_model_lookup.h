@@ -0,0 +1,56 @@
+/*
+ *  synapse_model_lookup.h
+ */
+
+#ifndef SYNAPSE_MODEL_LOOKUP_H
+#define SYNAPSE_MODEL_LOOKUP_H
+
+#include "connector_model.h"
+#include "dictutils.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+namespace mynest
+{
+
+/**
+ * Thread owning a connection of the synapse model syn_id. NEST passes the
+ * set_status of a connection the prototype of its synapse model on the
+ * thread of the connection, and the target of the _hpc models can only be
+ * resolved with that thread.
+ */
+inline nest::thread
+get_connection_thread( nest::synindex syn_id, const nest::ConnectorModel& cm )
+{
+  const nest::thread num_threads = nest::kernel().vp_manager.get_num_threads();
+  for ( nest::thread t = 0; t < num_threads; ++t )
+  {
+    if ( &nest::kernel().model_manager.get_synapse_prototype( syn_id, t ) == &cm )
+    {
+      return t;
+    }
+  }
+  throw nest::KernelException( "The connector model is not a prototype of the synapse model of the connection." );
+}
+
+/**
+ * Number of connections of the synapse model of the connector model cm over
+ * all threads. The common properties are only passed their connector model,
+ * whose synapse id is looked up by name.
+ */
+inline size_t
+get_num_connections( const nest::ConnectorModel& cm )
+{
+  const Token synmodel = nest::kernel().model_manager.get_synapsedict()->lookup( cm.get_name() );
+  if ( synmodel.empty() )
+  {
+    // A model that is not registered yet has no connections
+    return 0;
+  }
+  return nest::kernel().connection_manager.get_num_connections(
+    static_cast< nest::synindex >( getValue< long >( synmodel ) ) );
+}
+
+} // of namespace mynest
+
+#endif // of #ifndef SYNAPSE_MODEL_LOOKUP_H
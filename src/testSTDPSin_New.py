@@ -52,7 +52,7 @@ weight_before = numpy.array(nest.GetStatus(connections, "weight"))
 nest.Simulate(1550)
 
 # Disable the plasticity and apply 
-#nest.SetStatus(connections, {'A_plus': 0.00, 'A_minus': 0.00})
+#nest.SetStatus(connections, {'plastic': False})
 
 weight_after = numpy.array(nest.GetStatus(connections, "weight"))
 
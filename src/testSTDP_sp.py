@@ -0,0 +1,85 @@
+import nest
+import numpy
+import matplotlib.pylab as pylab
+
+# Compare the single-precision synapse models (stdp_cos_synapse_sp and
+# stdp_sin_synapse_sp) against their double-precision versions. Every
+# presynaptic neuron fires once at a different time before the teaching
+# signal, so the weight changes sample the whole learning kernel.
+
+num_neuron_pre = 1000
+
+# Maximum difference (in nS) accepted between both precisions
+tolerance = 1.0e-4
+
+# Frequency of presynaptic spikes (one per synapsis)
+spike_freq_pre = 1000.0
+spike_times_pre = numpy.arange(400.0, 400.0+(1000.0/spike_freq_pre)*(num_neuron_pre), 1000./spike_freq_pre)
+test_spike_time = 1500.0
+teaching_spike_time = [1000.0]
+
+def run_protocol(neuron_model, neuron_params, teaching_receptor, syn_dict):
+	nest.ResetKernel()
+	nest.SetKernelStatus({'local_num_threads': 1})
+
+	SpGeneratorPre = nest.Create('spike_generator', num_neuron_pre)
+	NeuronPre = nest.Create('parrot_neuron', num_neuron_pre)
+	NeuronPost = nest.Create(neuron_model, 1, params=neuron_params)
+
+	SpGeneratorTeach = nest.Create('spike_generator', 1)
+	NeuronTeach = nest.Create('parrot_neuron', 1)
+
+	nest.SetStatus(SpGeneratorTeach, {'spike_times': teaching_spike_time})
+	for id_neuron,neuron in enumerate(SpGeneratorPre):
+		nest.SetStatus([neuron], {'spike_times': [spike_times_pre[id_neuron]]+[test_spike_time]})
+
+	nest.Connect(SpGeneratorPre, NeuronPre, 'one_to_one')
+	nest.Connect(SpGeneratorTeach, NeuronTeach, 'one_to_one')
+	nest.Connect(NeuronTeach, NeuronPost, 'one_to_one',
+				syn_spec={'model': 'static_synapse', 'weight': 10.0, 'delay':1.0, 'receptor_type':teaching_receptor})
+	nest.Connect(NeuronPre, NeuronPost, syn_spec=syn_dict)
+
+	connections = nest.GetConnections(source=NeuronPre, target=NeuronPost)
+	weight_before = numpy.array(nest.GetStatus(connections, "weight"))
+
+	nest.Simulate(1550)
+
+	weight_after = numpy.array(nest.GetStatus(connections, "weight"))
+
+	return weight_after-weight_before
+
+nest.Install('cerebellummodule')
+
+syn_dict_cos = {'weight': 1.0, 'delay':1.0, 'receptor_type':1,
+				'A_plus': 0.05, 'A_minus': 0.2, 'Wmin':0.00, 'Wmax':2.00,
+				'exponent': 2.0, 'tau_cos': 10.0}
+syn_dict_sin = {'weight': 1.0, 'delay':1.0, 'receptor_type':1,
+				'A_plus': 0.05, 'A_minus': 0.2, 'Wmin':0.00, 'Wmax':2.00,
+				'exponent': 20.0, 'peak': 100.0}
+
+tests = [('stdp_cos_synapse', 'iaf_cond_exp_cos', {"tau_cos": 10.0, "exponent": 2.0}, syn_dict_cos),
+		('stdp_sin_synapse', 'iaf_cond_exp_cs', {}, syn_dict_sin)]
+
+failed = False
+for synapse_model, neuron_model, neuron_params, syn_dict in tests:
+	syn_dict['model'] = synapse_model
+	diff_double = run_protocol(neuron_model, neuron_params, 3, syn_dict)
+	syn_dict['model'] = synapse_model + '_sp'
+	diff_single = run_protocol(neuron_model, neuron_params, 3, syn_dict)
+
+	max_error = numpy.max(numpy.abs(diff_single-diff_double))
+	print('%s_sp: maximum weight difference %g nS (tolerance %g nS)' % (synapse_model, max_error, tolerance))
+	if max_error > tolerance:
+		failed = True
+
+	pylab.figure()
+	pylab.plot(spike_times_pre, diff_double, label=synapse_model)
+	pylab.plot(spike_times_pre, diff_single, '--', label=synapse_model + '_sp')
+	pylab.xlabel('Presynaptic spike time (ms)')
+	pylab.ylabel('Weight Diff. (nS)')
+	pylab.legend()
+
+if failed:
+	raise AssertionError('Single-precision synapses differ from the double-precision models')
+
+pylab.show()
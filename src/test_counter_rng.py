@@ -0,0 +1,81 @@
+import nest
+import time
+import numpy
+
+# Simulate the same network of cd_poisson_generators and cd_poisson_neurons
+# with counter_rng for several numbers of threads. The spike trains must be
+# identical in every run.
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+num_neurons = 100
+sim_time = 5000.0
+
+def run(num_threads, mode):
+	nest.ResetKernel()
+	nest.SetKernelStatus({"local_num_threads": num_threads})
+
+	cur_generator = nest.Create('dc_generator', 1, params={'amplitude': 5.0})
+
+	params = {'min_rate': 3.0,
+			'max_rate': 30.0,
+			'min_current': -1.0,
+			'max_current': 10.0,
+			'counter_rng': True,
+			'rng_seed': 1234}
+	params.update(mode)
+
+	if mode.get('individual_spike_trains', False):
+		poisson = nest.Create('cd_poisson_generator', 1, params=params)
+		pop = nest.Create('parrot_neuron', num_neurons)
+		nest.Connect(cur_generator, poisson, 'all_to_all')
+		nest.Connect(poisson, pop, 'all_to_all')
+	else:
+		pop = nest.Create('cd_poisson_neuron', num_neurons, params=params)
+		nest.Connect(cur_generator, pop, 'all_to_all')
+
+	spike_detector = nest.Create('spike_detector')
+	nest.Connect(pop, spike_detector)
+
+	start = time.time()
+	nest.Simulate(sim_time)
+	elapsed = time.time() - start
+
+	events = nest.GetStatus(spike_detector, 'events')[0]
+	order = numpy.lexsort((events['times'], events['senders']))
+	return events['senders'][order], events['times'][order], elapsed
+
+for mode in [{}, {'exponential_intervals': True}, {'individual_spike_trains': True}]:
+	ref_senders, ref_times, _ = run(1, mode)
+	for num_threads in [1, 2, 4]:
+		senders, times, elapsed = run(num_threads, mode)
+		same = numpy.array_equal(senders, ref_senders) and numpy.array_equal(times, ref_times)
+		print('%-30s threads: %d, spikes: %d, time: %.3f s, identical: %s' %
+			(str(mode), num_threads, len(times), elapsed, same))
+
+# Cost of the counter-based generator in individual_spike_trains mode, where
+# a draw is needed for every target in every step. Each block of the
+# generator gives the counts of four consecutive steps of a target, so the
+# time should be close to that of the thread generator.
+def time_individual(counter_rng, num_targets=10000):
+	nest.ResetKernel()
+	nest.SetKernelStatus({"local_num_threads": 1})
+
+	poisson = nest.Create('cd_poisson_generator', 1, params={'min_rate': 3.0,
+			'max_rate': 30.0,
+			'individual_spike_trains': True,
+			'counter_rng': counter_rng,
+			'rng_seed': 1234})
+	pop = nest.Create('parrot_neuron', num_targets)
+	nest.Connect(poisson, pop, 'all_to_all')
+
+	start = time.time()
+	nest.Simulate(1000.0)
+	return time.time() - start
+
+thread_time = time_individual(False)
+counter_time = time_individual(True)
+print('individual_spike_trains, 10000 targets. Thread generator: %.3f s, counter-based generator: %.3f s (%.2fx)' %
+	(thread_time, counter_time, counter_time / thread_time))
@@ -0,0 +1,45 @@
+import nest
+import numpy
+
+# Check the receptors of iaf_cond_exp_cos and iaf_cond_exp_cs. Receptor 0 is
+# rejected, and the _hpc synapses connected to AMPA must drive the excitatory
+# conductance exactly like the standard synapses connected to AMPA.
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+AMPA = 1
+pf_rate = 50.0 # Hz
+sim_time = 1000.0
+
+for neuron_model, synapse_model in [('iaf_cond_exp_cos', 'stdp_cos_synapse'),
+				('iaf_cond_exp_cs', 'stdp_sin_synapse')]:
+	nest.ResetKernel()
+	nest.SetKernelStatus({'local_num_threads': 1})
+
+	PFGenerator = nest.Create('poisson_generator', 1, params={'rate': pf_rate})
+	NeuronPF = nest.Create('parrot_neuron', 1)
+	Neurons = nest.Create(neuron_model, 2)
+	nest.Connect(PFGenerator, NeuronPF)
+
+	try:
+		nest.Connect(NeuronPF, Neurons[:1], syn_spec={'model': 'static_synapse', 'receptor_type': 0})
+		print('%s rejects receptor 0: False' % neuron_model)
+	except nest.NESTError:
+		print('%s rejects receptor 0: True' % neuron_model)
+
+	# Without plasticity both synapses keep their weight
+	syn_params = {'weight': 1.0, 'delay': 1.0, 'receptor_type': AMPA, 'A_plus': 0.0, 'A_minus': 0.0}
+	nest.Connect(NeuronPF, Neurons[:1], syn_spec=dict(syn_params, model=synapse_model))
+	nest.Connect(NeuronPF, Neurons[1:], syn_spec=dict(syn_params, model=synapse_model + '_hpc'))
+
+	multimeter = nest.Create('multimeter', params={'record_from': ['g_ex'], 'interval': 0.1})
+	nest.Connect(multimeter, Neurons)
+
+	nest.Simulate(sim_time)
+
+	events = nest.GetStatus(multimeter, 'events')[0]
+	g_ex = [events['g_ex'][events['senders'] == gid] for gid in Neurons]
+	print('%s: max g_ex %.2f, max difference to %s_hpc: %.2e' %
+		(synapse_model, numpy.max(g_ex[0]), synapse_model, numpy.max(numpy.abs(g_ex[0] - g_ex[1]))))
@@ -0,0 +1,60 @@
+import nest
+import time
+import numpy
+
+# Compare the ODE solvers of iaf_cond_exp_cs. The same neuron receives the
+# same excitatory, inhibitory and complex spike inputs with every solver, and
+# the membrane potential and the spike times are compared against GSL.
+
+integrators = ['gsl', 'rkf45', 'rk4']
+
+num_neurons = 100
+
+sim_time = 2000.0
+
+# Maximum allowed difference of the membrane potential with GSL (mV)
+tolerance = {'rkf45': 1e-6, 'rk4': 1e-2}
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+results = {}
+for integrator in integrators:
+	nest.ResetKernel()
+	nest.SetKernelStatus({'local_num_threads': 1, 'resolution': 0.1, 'rng_seeds': [1]})
+
+	neurons = nest.Create('iaf_cond_exp_cs', num_neurons, params={'integrator': integrator})
+
+	exc_input = nest.Create('poisson_generator', params={'rate': 4000.0})
+	inh_input = nest.Create('poisson_generator', params={'rate': 1000.0})
+	cs_input = nest.Create('poisson_generator', params={'rate': 1.0})
+
+	receptors = nest.GetDefaults('iaf_cond_exp_cs')['receptor_types']
+	nest.Connect(exc_input, neurons, 'all_to_all', syn_spec={'weight': 1.0, 'receptor_type': receptors['AMPA']})
+	nest.Connect(inh_input, neurons, 'all_to_all', syn_spec={'weight': 1.0, 'receptor_type': receptors['GABA']})
+	nest.Connect(cs_input, neurons, 'all_to_all', syn_spec={'weight': 1.0, 'receptor_type': receptors['COMPLEX_SPIKE']})
+
+	multimeter = nest.Create('multimeter', params={'record_from': ['V_m'], 'interval': 0.1})
+	spike_detector = nest.Create('spike_detector')
+	nest.Connect(multimeter, neurons)
+	nest.Connect(neurons, spike_detector)
+
+	start = time.time()
+	nest.Simulate(sim_time)
+	elapsed = time.time() - start
+
+	events = nest.GetStatus(multimeter, 'events')[0]
+	order = numpy.lexsort((events['senders'], events['times']))
+	spikes = nest.GetStatus(spike_detector, 'events')[0]
+	results[integrator] = (events['V_m'][order], numpy.sort(spikes['times']), elapsed)
+
+reference_v, reference_spikes, reference_time = results['gsl']
+print('%-8s %-12s %-10s %s' % ('Solver', 'Max dV (mV)', 'Spikes', 'Time (s)'))
+print('%-8s %-12s %-10d %.3f' % ('gsl', '-', len(reference_spikes), reference_time))
+for integrator in integrators[1:]:
+	v, spikes, elapsed = results[integrator]
+	max_diff = numpy.max(numpy.abs(v - reference_v))
+	print('%-8s %-12.3g %-10d %.3f' % (integrator, max_diff, len(spikes), elapsed))
+	if max_diff > tolerance[integrator]:
+		print('  Difference with GSL above the tolerance (%g mV)' % tolerance[integrator])
@@ -0,0 +1,57 @@
+import nest
+import numpy
+
+# Connect current-driven Poisson sources directly to a Purkinje cell through
+# plastic synapses, without the parrot neuron layer of test_poisson.py. The
+# sources are cd_poisson_neuron nodes, which can be the source of plastic
+# synapses.
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({'local_num_threads': 1})
+
+num_neuron_pre = 1000
+num_neuron_post = 1
+
+cur_generator = nest.Create('dc_generator', 1)
+
+NeuronPF = nest.Create('cd_poisson_neuron', num_neuron_pre, params=
+													{'min_rate': 3.0,
+													'max_rate': 7.0,
+													'min_current': -1.0,
+													'max_current': 10.0})
+NeuronPC = nest.Create('iaf_cond_exp_cs', num_neuron_post)
+
+NeuronCF = nest.Create('cd_poisson_neuron', num_neuron_post, params=
+													{'min_rate': 1.0,
+													'max_rate': 1.0})
+
+SpDetector = nest.Create('spike_detector', 1)
+
+nest.Connect(cur_generator, NeuronPF, 'all_to_all')
+nest.SetStatus(cur_generator, {'amplitude': 5.0})
+
+PCReceptor = {'AMPA': 1, 'GABA': 2, 'COMPLEX_SPIKE' : 3}
+syn_dict_CFPC = {'model': 'static_synapse', 'weight': 10.0, 'delay':1.0, 'receptor_type':PCReceptor['COMPLEX_SPIKE']}
+nest.Connect(NeuronCF, NeuronPC, 'one_to_one', syn_spec=syn_dict_CFPC)
+syn_dict_PFPC = {'model': 'stdp_sin_synapse', 'weight': 1.0, 'delay':1.0, 'receptor_type':PCReceptor['AMPA'],
+				'A_plus': 0.05, 'A_minus': 0.2, 'Wmin':0.00, 'Wmax':2.00,
+				'exponent': 20.0, 'peak': 100.0}
+nest.Connect(NeuronPF, NeuronPC, syn_spec=syn_dict_PFPC)
+nest.Connect(NeuronPF+NeuronPC+NeuronCF, SpDetector, 'all_to_all')
+
+connections = nest.GetConnections(source=NeuronPF, target=NeuronPC)
+weight_before = numpy.array(nest.GetStatus(connections, "weight"))
+
+sim_time = 5000.0
+nest.Simulate(sim_time)
+
+weight_after = numpy.array(nest.GetStatus(connections, "weight"))
+
+events = nest.GetStatus(SpDetector, 'events')[0]
+pf_spikes = numpy.sum(numpy.in1d(events['senders'], NeuronPF))
+
+print('Mean PF rate: %.2f Hz' % (pf_spikes * 1000.0 / sim_time / num_neuron_pre))
+print('Mean weight before: %.4f, after: %.4f' % (numpy.mean(weight_before), numpy.mean(weight_after)))
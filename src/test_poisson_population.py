@@ -0,0 +1,59 @@
+import nest
+import time
+import numpy
+
+# Drive a population of mossy fibers with a single cd_poisson_generator in
+# individual_spike_trains mode, instead of one generator and parrot neuron per
+# fiber as in test_poisson.py. The trains of the fibers must have the rate
+# given by the input current and be independent of each other.
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({"local_num_threads": 1})
+
+num_neurons = 200
+
+cur_generator = nest.Create('dc_generator', 1)
+
+poisson = nest.Create('cd_poisson_generator', 1, params=
+													{'min_rate': 3.0,
+													'max_rate': 7.0,
+													'min_current': -1.0,
+													'max_current': 10.0,
+													'individual_spike_trains': True})
+
+pop_parrot = nest.Create('parrot_neuron', num_neurons)
+
+spike_detector = nest.Create('spike_detector')
+
+nest.Connect(cur_generator, poisson, 'all_to_all')
+nest.Connect(poisson, pop_parrot, 'all_to_all')
+nest.Connect(pop_parrot, spike_detector)
+
+nest.SetStatus(cur_generator, {'amplitude': 5.0})
+
+sim_time = 10000.0
+
+start = time.time()
+nest.Simulate(sim_time)
+elapsed = time.time() - start
+
+events = nest.GetStatus(spike_detector, 'events')[0]
+senders = events['senders']
+times = events['times']
+
+expected_rate = (5.0 + 1.0) / (10.0 + 1.0) * (7.0 - 3.0) + 3.0
+rates = numpy.array([numpy.sum(senders == gid) for gid in pop_parrot]) * 1000.0 / sim_time
+
+# Count the spikes of every fiber in 10 ms bins and compute the mean
+# correlation between pairs of fibers
+bins = numpy.arange(0.0, sim_time + 10.0, 10.0)
+counts = numpy.array([numpy.histogram(times[senders == gid], bins)[0] for gid in pop_parrot])
+corr = numpy.corrcoef(counts)
+mean_corr = numpy.mean(corr[numpy.triu_indices(num_neurons, 1)])
+
+print('Simulation time: %.3f s' % elapsed)
+print('Expected rate: %.2f Hz, mean rate: %.2f Hz (std %.2f Hz)' % (expected_rate, numpy.mean(rates), numpy.std(rates)))
+print('Mean pairwise correlation: %.4f' % mean_corr)
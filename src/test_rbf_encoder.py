@@ -0,0 +1,85 @@
+import nest
+import numpy
+
+# Encode constant input currents with a single rbf_encoder and compare the
+# firing rate of every mossy fiber with the multi-dimensional gaussian tuning
+# curve of its receptive field, with explicit centers and with a grid of
+# centers. For the grid, the centers reported by the encoder are also
+# compared with the expected layout (last input varying fastest).
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+min_rate = 1.0
+max_rate = 50.0
+widths = [0.3, 0.2]
+input_currents = [0.2, 0.5]
+sim_time = 20000.0
+
+def measure_rates(encoder_params):
+	nest.ResetKernel()
+	nest.SetKernelStatus({"local_num_threads": 1})
+
+	num_inputs = len(input_currents)
+	params = dict(encoder_params, num_inputs=num_inputs, min_rate=min_rate, max_rate=max_rate, widths=widths)
+	encoder = nest.Create('rbf_encoder', 1)
+	nest.SetStatus(encoder, params)
+	num_centers = nest.GetStatus(encoder, 'num_centers')[0]
+	centers = numpy.array(nest.GetStatus(encoder, 'centers')[0]).reshape(num_centers, num_inputs)
+
+	pop_parrot = nest.Create('parrot_neuron', num_centers)
+	nest.SetStatus(encoder, {'first_target': pop_parrot[0]})
+
+	spike_detector = nest.Create('spike_detector')
+
+	# The input d is received through receptor port d
+	for d, current in enumerate(input_currents):
+		cur_generator = nest.Create('dc_generator', 1, params={'amplitude': current})
+		nest.Connect(cur_generator, encoder, 'all_to_all', syn_spec={'receptor_type': d})
+	nest.Connect(encoder, pop_parrot, 'all_to_all')
+	nest.Connect(pop_parrot, spike_detector)
+
+	nest.Simulate(sim_time)
+
+	senders = nest.GetStatus(spike_detector, 'events')[0]['senders']
+	rates = numpy.array([numpy.sum(senders == gid) for gid in pop_parrot]) * 1000.0 / sim_time
+
+	distance = numpy.sum((numpy.array(input_currents) - centers)**2 / (2.0 * numpy.array(widths)**2), axis=1)
+	expected = min_rate + (max_rate - min_rate) * numpy.exp(-distance)
+	return centers, rates, expected
+
+def print_rates(title, centers, rates, expected):
+	print(title)
+	print('%-18s %-14s %s' % ('Center', 'Expected (Hz)', 'Measured (Hz)'))
+	for center, exp_rate, rate in zip(centers, expected, rates):
+		print('%-18s %-14.2f %.2f' % ('(%.3f, %.3f)' % tuple(center), exp_rate, rate))
+	print('Max deviation: %.2f Hz' % numpy.max(numpy.abs(rates - expected)))
+
+# Explicit centers
+explicit_centers = numpy.random.uniform(0.0, 1.0, (20, 2))
+centers, rates, expected = measure_rates({'centers': explicit_centers.flatten().tolist()})
+print_rates('Explicit centers', centers, rates, expected)
+print('Centers as given: %s' % numpy.allclose(centers, explicit_centers))
+
+# Regular grid
+grid_min = [-1.0, 0.0]
+grid_max = [1.0, 1.0]
+grid_size = [5, 4]
+centers, rates, expected = measure_rates({'grid_min': grid_min, 'grid_max': grid_max, 'grid_size': grid_size})
+print_rates('Grid of centers', centers, rates, expected)
+
+axes = [numpy.linspace(grid_min[d], grid_max[d], grid_size[d]) for d in range(len(grid_size))]
+grid_centers = numpy.array([(x0, x1) for x0 in axes[0] for x1 in axes[1]])
+print('Grid layout as expected: %s' % numpy.allclose(centers, grid_centers))
+
+# num_inputs cannot be lowered below the receptor ports already connected
+nest.ResetKernel()
+encoder = nest.Create('rbf_encoder', 1, params={'num_inputs': 2, 'widths': widths, 'centers': [0.5, 0.5]})
+cur_generator = nest.Create('dc_generator', 1)
+nest.Connect(cur_generator, encoder, 'all_to_all', syn_spec={'receptor_type': 1})
+try:
+	nest.SetStatus(encoder, {'num_inputs': 1, 'widths': [0.3], 'centers': [0.5]})
+	print('Lowering num_inputs after connecting rejected: False')
+except nest.NESTError:
+	print('Lowering num_inputs after connecting rejected: True')
@@ -0,0 +1,54 @@
+import nest
+import numpy
+
+# Encode a constant input current with a single rbf_poisson_generator and
+# compare the firing rate of every mossy fiber with the gaussian tuning curve
+# of its receptive field.
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({"local_num_threads": 1})
+
+num_centers = 50
+min_rate = 1.0
+max_rate = 50.0
+min_current = -1.0
+max_current = 1.0
+gau_width = 0.1
+input_current = 0.3
+
+cur_generator = nest.Create('dc_generator', 1, params={'amplitude': input_current})
+
+rbf = nest.Create('rbf_poisson_generator', 1, params=
+													{'num_centers': num_centers,
+													'min_rate': min_rate,
+													'max_rate': max_rate,
+													'min_current': min_current,
+													'max_current': max_current,
+													'gau_width': gau_width})
+
+pop_parrot = nest.Create('parrot_neuron', num_centers)
+
+spike_detector = nest.Create('spike_detector')
+
+nest.SetStatus(rbf, {'first_target': pop_parrot[0]})
+
+nest.Connect(cur_generator, rbf, 'all_to_all')
+nest.Connect(rbf, pop_parrot, 'all_to_all')
+nest.Connect(pop_parrot, spike_detector)
+
+sim_time = 20000.0
+nest.Simulate(sim_time)
+
+senders = nest.GetStatus(spike_detector, 'events')[0]['senders']
+rates = numpy.array([numpy.sum(senders == gid) for gid in pop_parrot]) * 1000.0 / sim_time
+
+centers = numpy.linspace(min_current, max_current, num_centers)
+expected = min_rate + (max_rate - min_rate) * numpy.exp(-(input_current - centers)**2 / (2.0 * gau_width**2))
+
+print('%-10s %-14s %s' % ('Center', 'Expected (Hz)', 'Measured (Hz)'))
+for center, exp_rate, rate in zip(centers, expected, rates):
+	print('%-10.3f %-14.2f %.2f' % (center, exp_rate, rate))
+print('Max deviation: %.2f Hz' % numpy.max(numpy.abs(rates - expected)))
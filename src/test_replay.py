@@ -0,0 +1,71 @@
+import nest
+import time
+import numpy
+
+# Replay a recorded input trajectory from a binary trace file into a
+# population of cd_poisson_generators, instead of streaming the amplitudes of
+# dc_generators from Python. The firing rate of every generator must follow
+# its trace.
+
+trace_file = '/tmp/cerebellum_trace.bin'
+num_neurons = 200
+input_period = 5.0 # ms
+sim_time = 10000.0
+
+def write_trace_file(traces):
+	header = numpy.zeros(16, dtype='<u4')
+	header[0] = 0x53544243
+	header[1] = 1
+	header[2] = traces.shape[1]
+	with open(trace_file, 'wb') as f:
+		header.tofile(f)
+		traces.astype('<f8').tofile(f)
+
+# Slow sinusoidal currents between -1 and 10 nA, one phase per generator
+sample_times = numpy.arange(0.0, sim_time + input_period, input_period)
+phases = numpy.linspace(0.0, 2.0 * numpy.pi, num_neurons, endpoint=False)
+traces = 4.5 + 5.5 * numpy.sin(2.0 * numpy.pi * sample_times[:, None] * 1e-3 + phases[None, :])
+write_trace_file(traces)
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({"local_num_threads": 1})
+
+pop_poisson = nest.Create('cd_poisson_generator', num_neurons, params=
+													{'min_rate': 3.0,
+													'max_rate': 50.0,
+													'min_current': -1.0,
+													'max_current': 10.0,
+													'input_file': trace_file,
+													'input_period': input_period,
+													'input_type': 'current'})
+nest.SetStatus(pop_poisson, [{'input_column': i} for i in range(num_neurons)])
+
+pop_parrot = nest.Create('parrot_neuron', num_neurons)
+
+spike_detector = nest.Create('spike_detector')
+
+nest.Connect(pop_poisson, pop_parrot, 'one_to_one')
+nest.Connect(pop_parrot, spike_detector)
+
+start = time.time()
+nest.Simulate(sim_time)
+elapsed = time.time() - start
+
+events = nest.GetStatus(spike_detector, 'events')[0]
+senders = events['senders']
+times = events['times']
+
+# Compare the rate of every generator in 100 ms bins with its trace
+bins = numpy.arange(0.0, sim_time + 100.0, 100.0)
+centers = 0.5 * (bins[:-1] + bins[1:])
+measured = numpy.array([numpy.histogram(times[senders == gid], bins)[0] for gid in pop_parrot]) * 10.0
+currents = numpy.array([numpy.interp(centers, sample_times, traces[:, i]) for i in range(num_neurons)])
+expected = 3.0 + (numpy.clip(currents, -1.0, 10.0) + 1.0) / 11.0 * (50.0 - 3.0)
+
+print('Simulation time: %.3f s for %.1f s of simulated time' % (elapsed, sim_time * 1e-3))
+print('Mean rate: expected %.2f Hz, measured %.2f Hz' % (numpy.mean(expected), numpy.mean(measured)))
+print('Correlation between expected and measured rates: %.3f' %
+	numpy.corrcoef(expected.ravel(), measured.ravel())[0, 1])
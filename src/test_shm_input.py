@@ -0,0 +1,98 @@
+import nest
+import time
+import numpy
+import multiprocessing
+
+# Closed-loop input through shared memory. A producer process stands in for
+# the robot and publishes the input currents of the cd_poisson_generators
+# every 2 ms in a ring buffer in /dev/shm. The shm_current_generator injects
+# the last record every min_delay, so the network runs in a single call to
+# Simulate instead of one Simulate and one SetStatus per step as in
+# test_poisson.py.
+
+shm_file = '/dev/shm/cerebellum_input'
+num_neurons = 200
+num_slots = 64
+period = 0.002 # s between records
+
+header_dtype = numpy.dtype([('magic', '<u4'), ('version', '<u4'),
+							('num_channels', '<u4'), ('num_slots', '<u4'),
+							('write_count', '<u8'), ('padding', '<u8', 5)])
+
+def create_buffer():
+	size = header_dtype.itemsize + num_slots * (num_neurons + 1) * 8
+	with open(shm_file, 'wb') as f:
+		f.write(b'\0' * size)
+	header = numpy.memmap(shm_file, dtype=header_dtype, mode='r+', shape=(1,))
+	header['magic'] = 0x49534243
+	header['version'] = 1
+	header['num_channels'] = num_neurons
+	header['num_slots'] = num_slots
+	header.flush()
+
+def producer(duration):
+	header = numpy.memmap(shm_file, dtype=header_dtype, mode='r+', shape=(1,))
+	records = numpy.memmap(shm_file, dtype='<f8', mode='r+', offset=header_dtype.itemsize,
+		shape=(num_slots, num_neurons + 1))
+	phases = numpy.linspace(0.0, 2.0 * numpy.pi, num_neurons, endpoint=False)
+	count = 0
+	start = time.monotonic()
+	while time.monotonic() - start < duration:
+		now = time.monotonic()
+		# Sinusoidal currents between -1 and 10 nA, one phase per fiber
+		record = records[count % num_slots]
+		record[1:] = 4.5 + 5.5 * numpy.sin(2.0 * numpy.pi * (now - start) + phases)
+		record[0] = now
+		# write_count is incremented once the record is complete
+		count += 1
+		header['write_count'] = count
+		time.sleep(max(0.0, period - (time.monotonic() - now)))
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({"local_num_threads": 1})
+
+create_buffer()
+
+pop_poisson = nest.Create('cd_poisson_generator', num_neurons, params=
+													{'min_rate': 3.0,
+													'max_rate': 50.0,
+													'min_current': -1.0,
+													'max_current': 10.0})
+
+shm_input = nest.Create('shm_current_generator', 1, params=
+													{'input_file': shm_file,
+													'first_target': pop_poisson[0]})
+
+pop_parrot = nest.Create('parrot_neuron', num_neurons)
+
+spike_detector = nest.Create('spike_detector')
+
+nest.Connect(shm_input, pop_poisson, 'all_to_all')
+nest.Connect(pop_poisson, pop_parrot, 'one_to_one')
+nest.Connect(pop_parrot, spike_detector)
+
+sim_time = 10000.0
+
+robot = multiprocessing.Process(target=producer, args=(sim_time * 1e-3 + 5.0,))
+robot.start()
+time.sleep(0.1)
+
+start = time.time()
+nest.Simulate(sim_time)
+elapsed = time.time() - start
+
+robot.terminate()
+robot.join()
+
+status = nest.GetStatus(shm_input)[0]
+senders = nest.GetStatus(spike_detector, 'events')[0]['senders']
+
+print('Simulation time: %.3f s for %.1f s of simulated time' % (elapsed, sim_time * 1e-3))
+print('Records read: %d, dropped: %d' % (status['records_read'], status['records_dropped']))
+print('Input latency: mean %.3f ms, max %.3f ms' % (status['latency_mean'], status['latency_max']))
+print('Input-to-spike latency: input latency + %.1f ms of simulated delay' %
+	nest.GetStatus(nest.GetConnections(shm_input), 'delay')[0])
+print('Average frequency: %.2f Hz' % (senders.size / (sim_time * num_neurons) * 1e3))
@@ -0,0 +1,77 @@
+import nest
+import time
+import numpy
+import struct
+
+# Play precomputed spike trains from a binary spike file with a population of
+# spike_file_neurons, instead of one spike_generator and parrot_neuron per
+# fiber as in testSTDPSin_New.py. The recorded spikes must be the spikes of
+# the file.
+
+spike_file = '/tmp/cerebellum_spikes.bin'
+num_fibers = 10000
+rate = 5.0 # Hz
+resolution = 0.1 # ms
+sim_time = 2000.0
+
+def varint(value):
+	out = bytearray()
+	while True:
+		byte = value & 0x7f
+		value >>= 7
+		if value:
+			out.append(byte | 0x80)
+		else:
+			out.append(byte)
+			return out
+
+def write_spike_file(steps, fibers):
+	# Sort by step and fiber, and delta-encode both
+	order = numpy.lexsort((fibers, steps))
+	body = bytearray()
+	prev_step = 0
+	prev_fiber = 0
+	for step, fiber in zip(steps[order], fibers[order]):
+		if step > prev_step:
+			body += varint(int(step - prev_step)) + varint(int(fiber))
+		else:
+			body += varint(0) + varint(int(fiber - prev_fiber))
+		prev_step = step
+		prev_fiber = fiber
+	header = struct.pack('<IIIIdQ', 0x46534243, 1, num_fibers, 0, resolution, len(steps))
+	with open(spike_file, 'wb') as f:
+		f.write(header.ljust(64, b'\0'))
+		f.write(body)
+
+num_steps = int(sim_time / resolution)
+num_spikes = numpy.random.poisson(rate * sim_time * 1e-3 * num_fibers)
+steps = numpy.random.randint(1, num_steps, num_spikes)
+fibers = numpy.random.randint(0, num_fibers, num_spikes)
+write_spike_file(steps, fibers)
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({"local_num_threads": 1, "resolution": resolution})
+
+start = time.time()
+pop_fibers = nest.Create('spike_file_neuron', num_fibers, params={'input_file': spike_file})
+nest.SetStatus(pop_fibers, {'first_neuron': pop_fibers[0]})
+
+spike_detector = nest.Create('spike_detector')
+
+nest.Connect(pop_fibers, spike_detector)
+setup = time.time() - start
+
+start = time.time()
+nest.Simulate(sim_time)
+elapsed = time.time() - start
+
+events = nest.GetStatus(spike_detector, 'events')[0]
+recorded = sorted(zip(numpy.round(events['times'] / resolution).astype(int), events['senders'] - pop_fibers[0]))
+expected = sorted(zip(steps, fibers))
+
+print('Setup time: %.3f s, simulation time: %.3f s' % (setup, elapsed))
+print('Spikes in the file: %d, recorded: %d' % (len(expected), len(recorded)))
+print('Identical spikes: %s' % (recorded == expected))
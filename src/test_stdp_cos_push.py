@@ -0,0 +1,80 @@
+import nest
+import numpy
+
+# Compare the weights learnt by stdp_cos_push_synapse and stdp_cos_synapse
+# from the same presynaptic and teaching spikes. The presynaptic spikes have a
+# longer delay than the teaching spikes, so many of them are delivered after
+# later teaching spikes. Both models must end with the same weights, up to
+# the precision of the look-up tables.
+
+nest.set_verbosity('M_WARNING')
+
+nest.Install('cerebellummodule')
+
+nest.SetKernelStatus({'local_num_threads': 1})
+
+num_neuron_pre = 200
+pf_rate = 20.0 # Hz
+cs_rate = 2.0 # Hz
+sim_time = 5000.0
+tau_cos = 10.0
+exponent = 2.0
+syn_params = {'A_plus': 0.001, 'A_minus': 0.01, 'Wmin': 0.0, 'Wmax': 10.0}
+
+PFGenerator = nest.Create('poisson_generator', 1, params={'rate': pf_rate})
+NeuronPF = nest.Create('parrot_neuron', num_neuron_pre)
+CSGenerator = nest.Create('poisson_generator', 1, params={'rate': cs_rate})
+NeuronCS = nest.Create('parrot_neuron', 1)
+
+# One target neuron per synapse model
+NeuronPush = nest.Create('iaf_cond_exp_cos', 1, params={'tau_cos': tau_cos, 'exponent': exponent})
+NeuronPull = nest.Create('iaf_cond_exp_cos', 1, params={'tau_cos': tau_cos, 'exponent': exponent})
+
+nest.Connect(PFGenerator, NeuronPF, 'all_to_all')
+nest.Connect(CSGenerator, NeuronCS, 'all_to_all')
+
+DCNReceptor = {'AMPA': 1, 'GABA': 2, 'TEACHING_SIGNAL' : 3}
+syn_dict_CS = {'model': 'static_synapse', 'weight': 1.0, 'delay': 1.0, 'receptor_type': DCNReceptor['TEACHING_SIGNAL']}
+nest.Connect(NeuronCS, NeuronPush + NeuronPull, 'all_to_all', syn_spec=syn_dict_CS)
+
+syn_dict_push = dict(syn_params, model='stdp_cos_push_synapse', weight=1.0, delay=5.0, receptor_type=DCNReceptor['AMPA'])
+nest.Connect(NeuronPF, NeuronPush, 'all_to_all', syn_spec=syn_dict_push)
+syn_dict_pull = dict(syn_params, model='stdp_cos_synapse', weight=1.0, delay=5.0, receptor_type=DCNReceptor['AMPA'],
+				exponent=exponent, tau_cos=tau_cos)
+nest.Connect(NeuronPF, NeuronPull, 'all_to_all', syn_spec=syn_dict_pull)
+
+nest.Simulate(sim_time)
+
+# Each synapse applies its weight change when its next presynaptic spike
+# arrives, so the weights are compared after a final presynaptic spike
+final_spike = nest.Create('spike_generator', 1, params={'spike_times': [sim_time + 50.0]})
+nest.Connect(final_spike, NeuronPF, 'all_to_all')
+nest.Simulate(100.0)
+
+push_connections = nest.GetConnections(source=NeuronPF, target=NeuronPush)
+pull_connections = nest.GetConnections(source=NeuronPF, target=NeuronPull)
+push_weights = numpy.array(nest.GetStatus(push_connections, 'weight'))
+pull_weights = numpy.array(nest.GetStatus(pull_connections, 'weight'))
+
+print('Mean weight change. Push: %.5f, pull: %.5f' % (numpy.mean(push_weights - 1.0), numpy.mean(pull_weights - 1.0)))
+print('Max weight difference: %.2e' % numpy.max(numpy.abs(push_weights - pull_weights)))
+
+# Replace half of the connections. The new push-mode connections reuse the
+# slots released in the target, and must start from a clean trace like the
+# new stdp_cos_synapse connections.
+replaced = NeuronPF[:num_neuron_pre//2]
+nest.Disconnect(replaced, NeuronPush*len(replaced), 'one_to_one', syn_spec={'model': 'stdp_cos_push_synapse'})
+nest.Disconnect(replaced, NeuronPull*len(replaced), 'one_to_one', syn_spec={'model': 'stdp_cos_synapse'})
+nest.Connect(replaced, NeuronPush, 'all_to_all', syn_spec=syn_dict_push)
+nest.Connect(replaced, NeuronPull, 'all_to_all', syn_spec=syn_dict_pull)
+
+nest.Simulate(sim_time)
+nest.SetStatus(final_spike, {'spike_times': [2.0*sim_time + 150.0]})
+nest.Simulate(100.0)
+
+push_connections = nest.GetConnections(source=replaced, target=NeuronPush)
+pull_connections = nest.GetConnections(source=replaced, target=NeuronPull)
+push_weights = numpy.array(nest.GetStatus(push_connections, 'weight'))
+pull_weights = numpy.array(nest.GetStatus(pull_connections, 'weight'))
+
+print('Reconnected synapses. Max weight difference: %.2e' % numpy.max(numpy.abs(push_weights - pull_weights)))
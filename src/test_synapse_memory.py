@@ -0,0 +1,63 @@
+import nest
+
+# Compare the memory used by the plastic synapse models of the module. Every
+# model connects the same populations all-to-all in a fresh kernel, and the
+# memory of the process is measured before and after connecting.
+
+num_neuron_pre = 2000
+num_neuron_post = 200
+
+# The _hpc models are connected to AMPA as well, which the neurons store as
+# port 0, the only port these models support
+synapse_models = [('stdp_cos_synapse', 'iaf_cond_exp_cos', 1),
+				('stdp_cos_synapse_hpc', 'iaf_cond_exp_cos', 1),
+				('stdp_cos_synapse_sp', 'iaf_cond_exp_cos', 1),
+				('stdp_cos_q16_synapse', 'iaf_cond_exp_cos', 1),
+				('stdp_cos_shared_synapse', 'iaf_cond_exp_cos', 1),
+				('stdp_sin_synapse', 'iaf_cond_exp_cs', 1),
+				('stdp_sin_synapse_hpc', 'iaf_cond_exp_cs', 1),
+				('stdp_sin_synapse_sp', 'iaf_cond_exp_cs', 1),
+				('stdp_sin_q16_synapse_e2', 'iaf_cond_exp_cs', 1),
+				('stdp_sin_q16_synapse_e20', 'iaf_cond_exp_cs', 1)]
+
+def memory_kb():
+	return nest.ll_api.sli_func('memory_thisjob')
+
+nest.Install('cerebellummodule')
+
+results = []
+for synapse_model, neuron_model, receptor in synapse_models:
+	nest.ResetKernel()
+	nest.SetKernelStatus({'local_num_threads': 1})
+
+	NeuronPre = nest.Create('parrot_neuron', num_neuron_pre)
+	NeuronPost = nest.Create(neuron_model, num_neuron_post)
+
+	memory_before = memory_kb()
+	nest.Connect(NeuronPre, NeuronPost, 'all_to_all',
+				syn_spec={'model': synapse_model, 'weight': 1.0, 'delay': 1.0, 'receptor_type': receptor})
+	memory_after = memory_kb()
+
+	num_synapses = nest.GetKernelStatus('num_connections')
+	bytes_per_synapse = (memory_after-memory_before)*1024.0/num_synapses
+	results.append((synapse_model, bytes_per_synapse))
+
+print('%-26s %s' % ('Synapse model', 'Bytes per synapse'))
+for synapse_model, bytes_per_synapse in results:
+	print('%-26s %.1f' % (synapse_model, bytes_per_synapse))
+
+sizes = dict(results)
+
+# The single precision models keep the spike times in double precision, so
+# they are smaller but not half the size of the double precision ones
+for synapse_model in ['stdp_cos_synapse', 'stdp_sin_synapse']:
+	print('%s: %.1f bytes in double precision, %.1f bytes in single precision' %
+		(synapse_model, sizes[synapse_model], sizes[synapse_model + '_sp']))
+
+# The 16-bit sin synapses store the state variables of their exponent inline,
+# so even the largest exponent must take less memory than stdp_sin_synapse
+for synapse_model in ['stdp_sin_q16_synapse_e2', 'stdp_sin_q16_synapse_e20']:
+	assert sizes[synapse_model] < sizes['stdp_sin_synapse'], \
+		'%s is not smaller than stdp_sin_synapse' % synapse_model
+assert sizes['stdp_sin_q16_synapse_e2'] < sizes['stdp_sin_q16_synapse_e20'], \
+	'stdp_sin_q16_synapse_e2 does not store fewer state variables'